@@ -0,0 +1,79 @@
+/**
+ * @file AlignedArray.h
+ * @brief Declaration and implementation of the AlignedArray class template.
+ *
+ * The AlignedArray class is a fixed-size array whose storage starts on a cache line boundary.
+ * It is used for the structure-of-arrays hot state of the simulation, where every field of every
+ * car or floor is kept in its own contiguous array.
+ */
+
+#pragma once
+#include <memory_resource>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+
+template <typename T>
+class AlignedArray {
+	static_assert(std::is_trivially_copyable<T>::value, "AlignedArray only holds trivially copyable values");
+
+public:
+	static constexpr size_t ALIGNMENT = 64; /**< The alignment of the storage, one cache line. */
+
+	/**
+	 * @brief Constructs an array of the given size with every element set to the same value.
+	 *
+	 * @param size The number of elements.
+	 * @param value The initial value of every element.
+	 * @param resource The memory resource providing the storage.
+	 */
+	AlignedArray(size_t size, const T& value, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: count(size), resource(resource) {
+		data = static_cast<T*>(resource->allocate(bytes(), ALIGNMENT));
+		std::fill(data, data + count, value);
+	}
+
+	AlignedArray(const AlignedArray&) = delete;
+	AlignedArray& operator=(const AlignedArray&) = delete;
+
+	AlignedArray(AlignedArray&& other) noexcept : data(other.data), count(other.count), resource(other.resource) {
+		other.data = nullptr;
+		other.count = 0;
+	}
+
+	~AlignedArray() {
+		if (data != nullptr) {
+			resource->deallocate(data, bytes(), ALIGNMENT);
+		}
+	}
+
+	T& operator[](size_t index) { return data[index]; }
+	const T& operator[](size_t index) const { return data[index]; }
+
+	/**
+	 * @brief Gets the number of elements.
+	 *
+	 * @return The number of elements.
+	 */
+	size_t size() const { return count; }
+
+	T* begin() { return data; }
+	T* end() { return data + count; }
+	const T* begin() const { return data; }
+	const T* end() const { return data + count; }
+
+private:
+	T* data = nullptr; // The aligned storage.
+	size_t count; // The number of elements.
+	std::pmr::memory_resource* resource; // The memory resource owning the storage.
+
+	/**
+	 * @brief Gets the size of the storage, rounded up to whole cache lines.
+	 *
+	 * @return The size in bytes, never zero.
+	 */
+	size_t bytes() const {
+		size_t raw = std::max<size_t>(count * sizeof(T), 1);
+		return (raw + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+};
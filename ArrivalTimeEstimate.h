@@ -0,0 +1,88 @@
+/**
+ * @file ArrivalTimeEstimate.h
+ * @brief Estimates of the time and energy each car needs to reach a hall call.
+ *
+ * The estimates are shared by the policies that assign calls or passengers to single cars. Each is computed for
+ * all active cars in one branch-free pass over the bank's structure-of-arrays state, so the compiler can
+ * vectorize it and assignment stays cheap for large groups.
+ */
+
+#pragma once
+#include "ElevatorBank.h"
+#include "ElevatorState.h"
+#include "EnergyModel.h"
+#include <cstdlib>
+
+/**
+ * @brief Estimates the time of arrival of every active car at a hall call.
+ *
+ * The distance assumes a car runs to the end of the building before turning around, as it would with
+ * demand everywhere, at the car's own speed. Each rider on board and each stop assigned to the car adds one
+ * of the car's stops. Every branch is written as a select so the loop over cars has no control flow.
+ *
+ * @param bank The elevators of the building.
+ * @param floorNumber The floor of the hall call.
+ * @param direction The direction of the hall call.
+ * @param assignedStops The number of stops assigned to each car on top of its riders.
+ * @param eta Receives the estimated time of arrival of each active car, in seconds.
+ */
+inline void estimateArrivalTimes(const ElevatorBank& bank, int floorNumber, ElevatorDirection direction, const int* assignedStops, int* eta) {
+	const int n = bank.getNumOfActiveCars();
+	const int top = bank.getNumOfFloors();
+	const int callUp = direction == ElevatorDirection::UP;
+	const int f = floorNumber;
+	const int* position = bank.getCurrentFloors().begin();
+	const ElevatorDirection* carDirection = bank.getDirections().begin();
+	const ElevatorState* carState = bank.getStates().begin();
+	const int* load = bank.getLoads().begin();
+	const int* speed = bank.getSpeeds().begin();
+	const int* stopTime = bank.getStopTimes().begin();
+
+	for (int car = 0; car < n; ++car) {
+		const int p = position[car];
+		const int carUp = carDirection[car] == ElevatorDirection::UP;
+		const int stops = load[car] + assignedStops[car];
+		const int idle = ((carState[car] == ElevatorState::STOPPED) | (carState[car] == ElevatorState::IDLE)) & (stops == 0);
+
+		// car going up: reach an up call ahead directly, otherwise via the top (and the bottom for an up call behind)
+		const int upDistance = callUp
+			? (f >= p ? f - p : (top - p) + (top - 1) + (f - 1))
+			: (top - p) + (top - f);
+		// car going down: the mirror image
+		const int downDistance = callUp
+			? (p - 1) + (f - 1)
+			: (f <= p ? p - f : (p - 1) + (top - 1) + (top - f));
+		const int idleDistance = p > f ? p - f : f - p;
+
+		const int distance = idle ? idleDistance : (carUp ? upDistance : downDistance);
+		eta[car] = distance * speed[car] + stops * stopTime[car];
+	}
+}
+
+/**
+ * @brief Estimates the energy every active car would add by answering a hall call.
+ *
+ * An idle car makes a run from rest to the call at its load. A busy car is already on its way, and the
+ * call costs it one more stop and start.
+ *
+ * @param bank The elevators of the building.
+ * @param floorNumber The floor of the hall call.
+ * @param assignedStops The number of stops assigned to each car on top of its riders.
+ * @param energy Receives the estimated energy of each active car, in kWh.
+ */
+inline void estimateCallEnergies(const ElevatorBank& bank, int floorNumber, const int* assignedStops, double* energy) {
+	const int n = bank.getNumOfActiveCars();
+	const EnergyModel& model = bank.getEnergyModel();
+	const int* position = bank.getCurrentFloors().begin();
+	const ElevatorState* carState = bank.getStates().begin();
+	const int* load = bank.getLoads().begin();
+
+	for (int car = 0; car < n; ++car) {
+		const int p = position[car];
+		const bool idle = (carState[car] == ElevatorState::STOPPED || carState[car] == ElevatorState::IDLE) && load[car] + assignedStops[car] == 0;
+		const ElevatorDirection toCall = floorNumber >= p ? ElevatorDirection::UP : ElevatorDirection::DOWN;
+		energy[car] = idle
+			? model.runEnergy(std::abs(floorNumber - p), toCall, load[car], bank.getCapacity(car), true)
+			: model.startStopEnergy;
+	}
+}
@@ -13,8 +13,24 @@
 #pragma once
 #include"Passenger.h"
 #include"Statistic.h"
-#include"Elevator.h"
-#include"Floor.h"
+#include"ElevatorBank.h"
+#include"DispatchPolicy.h"
+#include"GroupControlPolicy.h"
+#include"DestinationDispatchPolicy.h"
+#include"FloorSet.h"
+#include"DeliverySink.h"
+#include"SimulationArena.h"
+#include"SimulationLog.h"
+#include"CarSchedule.h"
+#include"CarKinematics.h"
+#include"DoorDwell.h"
+#include"CarSpec.h"
+#include"ZoneTopology.h"
+#include"EnergyModel.h"
+#include"ParkingPolicy.h"
+#include"TrafficMode.h"
+#include"TimingWheel.h"
+#include"Patience.h"
 #include "spdlog/spdlog.h"
 #include<queue>
 #include <iostream>
@@ -22,6 +38,12 @@
 #include <sstream>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <string>
+#include <memory>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
 
 class Building {
 public:
@@ -36,80 +58,656 @@ public:
 	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
 	 * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
 	 * @param logFileName The name of the log file to store simulation information.
+	 * @throw std::out_of_range if a passenger's start or end floor is not in the building.
 	 */
-	Building(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, std::string logFileName) : NUM_OF_FLOORS{ numOfFloors }, NUM_OF_ELEVATORS{ numOfElevators }, ELEVATOR_SPEED{ elevatorSpeed }, ELEVATOR_STOPPING_TIME{ elevatorStoppingTime }, logFileName{ logFileName }, logFileLocation{ "logs/" + logFileName + "_passenger_log" + ".txt" } {
-		// initialize containers
-		initalizeFloors();
-		initalizeElevators();
-		initalizePassengers();
+	Building(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, std::string logFileName)
+		: Building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, logFileName, readTrace(TRACE_FILE_NAME)) {
+	}
 
-		// for error checking
-		totalPassenger = passengers.size();
+	/**
+	 * @brief Constructs a Building object that replays an already loaded passenger trace.
+	 *
+	 * Loading the trace once with readTrace and sharing it saves parsing the CSV file for every run
+	 * when the same trace is simulated many times.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param numOfElevators The number of elevators in the building.
+	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+	 * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+	 * @param logFileName The name of the log file to store simulation information.
+	 * @param trace The passengers to simulate, in order of arrival.
+	 * @param quiet True to write no log files and print nothing, e.g. for the runs of an optimizer.
+	 * @throw std::out_of_range if a passenger's start or end floor is not in the building.
+	 */
+	Building(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, std::string logFileName,
+		const std::vector<Passenger>& trace, bool quiet = false)
+		: NUM_OF_FLOORS{ numOfFloors }, NUM_OF_ELEVATORS{ numOfElevators }, ELEVATOR_SPEED{ elevatorSpeed }, ELEVATOR_STOPPING_TIME{ elevatorStoppingTime },
+		floors(numOfFloors, &arena), elevators(numOfElevators, numOfFloors, elevatorSpeed, elevatorStoppingTime, logFileName, &arena, quiet),
+		schedule(CarSchedule::staggered(numOfElevators)), logFileName{ logFileName }, logFileLocation{ "logs/" + logFileName + "_passenger_log" + ".txt" },
+		quiet(quiet) {
+		// initialize containers, counting every member of a group for error checking
+		for (const Passenger& passenger : trace) {
+			if (passenger.getStartFloor() > numOfFloors || passenger.getEndFloor() > numOfFloors) {
+				throw std::out_of_range("Passenger " + std::to_string(passenger.getPassengerID()) + " travels from floor "
+					+ std::to_string(passenger.getStartFloor()) + " to floor " + std::to_string(passenger.getEndFloor())
+					+ ", which is not in the building");
+			}
+			passengers.push(passenger);
+			totalPassenger += static_cast<size_t>(passenger.getGroupSize());
+		}
+
+		elevators.addStopSink(stopTimeSink);
 	}
 
 	/**
-	 * @brief Simulates elevator behavior in the building.
+	 * @brief Reads a passenger trace from a CSV file with one "start time, start floor, end floor" line per passenger.
+	 *
+	 * Passengers get IDs from 1 in file order. The first line of the file is a header and is skipped. A line
+	 * may end with a fourth "group size" field for people arriving together; it stands for one passenger otherwise.
+	 *
+	 * @param fileName The CSV file to read.
+	 * @return The passengers, in file order.
+	 * @throw std::invalid_argument if a group size is not between 1 and Passenger::MAX_GROUP_SIZE.
+	 * @throw std::out_of_range if a start time is later than Passenger::MAX_START_TIME.
+	 */
+	static std::vector<Passenger> readTrace(const std::string& fileName) {
+		std::vector<Passenger> trace;
+		std::ifstream inputFile(fileName); // open csv
+		std::string line;
+		int startFloor = 1;
+		int endFloor = 1;
+		int startTime = 1;
+		int groupSize = 1;
+		int id = 1;
+
+		std::getline(inputFile, line); // skip first line)
+
+		// read each line and create passenger object
+		while (std::getline(inputFile, line)) {
+			std::stringstream ss(line);
+			std::string token;
+			while (std::getline(ss, token, ',')) {
+				startTime = std::stoi(token);
+				std::getline(ss, token, ',');
+				startFloor = std::stoi(token);
+				std::getline(ss, token, ',');
+				endFloor = std::stoi(token);
+				groupSize = std::getline(ss, token, ',') ? std::stoi(token) : 1;
+			}
+			trace.emplace_back(id, startTime, startFloor, endFloor, groupSize);
+			++id;
+		}
+		inputFile.close();
+		return trace;
+	}
+
+	/**
+	 * @brief Sets when each car goes into service and where it parks.
+	 *
+	 * The default is CarSchedule::staggered. Call it before simulate, since it moves the cars to their parking floors.
+	 *
+	 * @param carSchedule The schedule, with one entry per elevator.
+	 * @throw std::invalid_argument if the schedule does not have one entry per elevator.
+	 * @throw std::out_of_range if a parking floor is not in the building.
+	 */
+	void setCarSchedule(const CarSchedule& carSchedule) {
+		if (carSchedule.size() != NUM_OF_ELEVATORS) {
+			throw std::invalid_argument("The car schedule must have one entry per elevator");
+		}
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			elevators.setParkingFloor(car, carSchedule.getParkingFloor(car));
+		}
+		schedule = carSchedule;
+	}
+
+	/**
+	 * @brief Gets when each car goes into service and where it parks.
+	 *
+	 * @return The car schedule.
+	 */
+	const CarSchedule& getCarSchedule() const {
+		return schedule;
+	}
+
+	/**
+	 * @brief Sets whether delivered passengers are kept on their destination floor.
+	 *
+	 * Retention is off by default so memory use does not grow with the number of trips.
+	 * Turn it on to inspect Floor::getDeliveredPassengers after simulate.
+	 *
+	 * @param retain True to keep delivered passengers, false to only stream them to the sinks.
+	 */
+	void setRetainDeliveredPassengers(bool retain) {
+		retainDeliveredPassengers = retain;
+	}
+
+	/**
+	 * @brief Adds a sink that receives every passenger when they are dropped off.
+	 *
+	 * Added sinks run after the built-in statistics and time log sinks.
+	 *
+	 * @param sink The sink to add.
+	 */
+	void addDeliverySink(std::unique_ptr<DeliverySink> sink) {
+		extraDeliverySinks.push_back(std::move(sink));
+	}
+
+	/**
+	 * @brief Gets the memory arena holding the simulation containers.
+	 *
+	 * @return The arena, for reading its peak and total byte counts.
+	 */
+	const SimulationArena& getArena() const {
+		return arena;
+	}
+
+	/**
+	 * @brief Gets the statistic of passenger wait times.
+	 *
+	 * @return The wait time statistic, complete once simulate has returned.
+	 */
+	const Statistic& getWaitTimeStat() const {
+		return waitTimeStat;
+	}
+
+	/**
+	 * @brief Gets the statistic of passenger travel times.
+	 *
+	 * @return The travel time statistic, complete once simulate has returned.
+	 */
+	const Statistic& getTravelTimeStat() const {
+		return travelTimeStat;
+	}
+
+	/**
+	 * @brief Gets the number of passengers in the trace, counting every member of a group.
+	 *
+	 * @return The number of passengers.
+	 */
+	size_t getPassengerCount() const {
+		return totalPassenger;
+	}
+
+	/**
+	 * @brief Sets the maximum number of passengers every elevator can carry. Call it before simulate.
+	 *
+	 * @param capacity The capacity.
+	 * @throw std::invalid_argument if capacity is less than 1.
+	 */
+	void setCapacity(int capacity) {
+		elevators.setCapacity(capacity);
+	}
+
+	/**
+	 * @brief Gives every car its own speed, stopping time, capacity and served floors. Call it before simulate.
+	 *
+	 * Hall calls are then answered only by cars serving both the floor of the call and the destination of
+	 * someone waiting for it. Call it before setKinematics, which replaces the flight times it sets.
+	 *
+	 * @param specs The specifications, with one entry per elevator.
+	 * @throw std::invalid_argument if there is not one specification per elevator or a value is less than 1.
+	 * @throw std::out_of_range if a served floor is not in the building.
+	 */
+	void setCarSpecs(const std::vector<CarSpec>& specs) {
+		if (specs.size() != static_cast<size_t>(NUM_OF_ELEVATORS)) {
+			throw std::invalid_argument("The car specifications must have one entry per elevator");
+		}
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			elevators.setCarSpec(car, specs[car]);
+		}
+		floors.setServedFloorMasks(elevators.getServedFloorMasks());
+	}
+
+	/**
+	 * @brief Splits the cars into zoned groups and routes trips no single group serves through transfer floors. Call it before simulate.
+	 *
+	 * The cars get the specifications of their groups. Passengers changing groups leave their car at a
+	 * transfer floor and join the hall queue there one second later. The wait and travel statistics then
+	 * count each trip once, with the waits of all its legs as wait time; getJourneys has the per-leg figures.
+	 *
+	 * @param topology The elevator groups of the building.
+	 * @throw std::invalid_argument if the groups do not have one car per elevator in total.
+	 */
+	void setTopology(const ZoneTopology& topology) {
+		if (topology.getNumOfCars() != NUM_OF_ELEVATORS) {
+			throw std::invalid_argument("The elevator groups must have one car per elevator in total");
+		}
+		setCarSpecs(topology.getCarSpecs());
+		journeys.setTopology(topology);
+	}
+
+	/**
+	 * @brief Splits the main lobby between the two decks of double-deck cars. Call it before simulate.
+	 *
+	 * The lower deck loads at the lobby and the upper deck one floor above it, reached by escalator. A
+	 * passenger leaving the lobby for a floor an odd number of floors above it starts at the upper lobby
+	 * instead, so each deck reaches its riders' floors at the same stops; a passenger going to the lobby
+	 * from such a floor gets off at the upper lobby.
+	 *
+	 * @param lobbyFloor The floor of the main lobby, 0 to switch the rule off.
+	 * @throw std::out_of_range if the lobby and the floor above it are not in the building.
+	 */
+	void setDoubleDeckLobby(int lobbyFloor) {
+		if (lobbyFloor != 0 && (lobbyFloor < 1 || lobbyFloor >= NUM_OF_FLOORS)) {
+			throw std::out_of_range("The double-deck lobby and the floor above it must be in the building");
+		}
+		doubleDeckLobby = lobbyFloor;
+	}
+
+	/**
+	 * @brief Gets the journey times of the trips and the wait and travel times of each leg.
+	 *
+	 * @return The journeys, complete once simulate has returned.
+	 */
+	const JourneySink& getJourneys() const {
+		return journeys;
+	}
+
+	/**
+	 * @brief Replaces the fixed time per floor with a kinematic model of the cars. Call it before simulate.
+	 *
+	 * The flight time of every run in the building is computed here, once, so the simulation only looks them up.
+	 *
+	 * @param kinematics The speed, acceleration and jerk limits of the cars.
+	 */
+	void setKinematics(const CarKinematics& kinematics) {
+		elevators.setFlightTimes(kinematics.flightTimeTable(NUM_OF_FLOORS));
+	}
+
+	/**
+	 * @brief Replaces the time per floor of one car with a kinematic model, e.g. for an express car. Call it before simulate.
+	 *
+	 * @param car The index of the elevator.
+	 * @param kinematics The speed, acceleration and jerk limits of the car.
+	 */
+	void setKinematics(int car, const CarKinematics& kinematics) {
+		elevators.setFlightTimes(car, kinematics.flightTimeTable(NUM_OF_FLOORS));
+	}
+
+	/**
+	 * @brief Replaces the fixed stopping time with door and per-passenger transfer times. Call it before simulate.
+	 *
+	 * @param model The door timings and transfer times.
+	 * @throw std::invalid_argument if a time is negative.
+	 */
+	void setDwellModel(const DwellModel& model) {
+		elevators.setDwellModel(model);
+	}
+
+	/**
+	 * @brief Adds a sink that receives every stop of every car once its doors have closed.
+	 *
+	 * @param sink The sink to add.
+	 */
+	void addStopSink(std::unique_ptr<StopSink> sink) {
+		elevators.addStopSink(*sink);
+		extraStopSinks.push_back(std::move(sink));
+	}
+
+	/**
+	 * @brief Chooses the parking floors of idle cars with a policy instead of the fixed floors of the car schedule. Call it before simulate.
+	 *
+	 * The policy sees the start floor of every passenger joining a floor. A car picks a parking floor when it
+	 * runs out of work and gives it up once it boards someone or leaves it for a call.
+	 *
+	 * @param policy The parking policy, or nullptr to keep the parking floors of the car schedule.
+	 */
+	void setParkingPolicy(std::unique_ptr<ParkingPolicy> policy) {
+		parkingPolicy = std::move(policy);
+		elevators.setDynamicParking(parkingPolicy != nullptr);
+	}
+
+	/**
+	 * @brief Classifies the traffic of the building online as it arrives. Call it before simulate.
+	 *
+	 * Every passenger entering the building is counted. When the classifier sees a new regime, the dispatch
+	 * policy and the parking policy are told through their onTrafficModeChange hooks.
+	 *
+	 * @param settings The settings of the classifier.
+	 * @throw std::invalid_argument if the settings are invalid, see TrafficDetection::validate.
+	 */
+	void setTrafficDetection(const TrafficDetection& settings) {
+		traffic = std::make_unique<TrafficClassifier>(settings);
+	}
+
+	/**
+	 * @brief Gets the traffic classifier, with the timeline of the regimes seen.
+	 *
+	 * @return The classifier, or nullptr if traffic detection is off.
+	 */
+	const TrafficClassifier* getTrafficClassifier() const {
+		return traffic.get();
+	}
+
+	/**
+	 * @brief Lets groups that do not fit in a car board in part and leave the rest for the next car. Call it before simulate.
+	 *
+	 * Off by default: a group waits for a car with room for all of it, unless it is larger than a deck.
+	 *
+	 * @param split True to split groups, false to board them whole.
+	 */
+	void setGroupSplitting(bool split) {
+		elevators.setGroupSplitting(split);
+	}
+
+	/**
+	 * @brief Lets passengers give up waiting and balk at long queues. Call it before simulate.
+	 *
+	 * Every passenger joining a floor draws a patience from the model and leaves the queue once it runs
+	 * out, unless a car has picked them up by then; the dispatch policy is told through its onAbandon hook.
+	 * A passenger arriving at a queue of the balking length leaves at once. Both count as served when
+	 * checking that every passenger was delivered.
+	 *
+	 * @param model The patience model.
+	 * @throw std::invalid_argument if the model is invalid, see PatienceModel::validate.
+	 */
+	void setPatience(const PatienceModel& model) {
+		model.validate();
+		patience = model;
+		patienceEnabled = true;
+		patienceRandom.seed(model.seed);
+		patienceDistribution = model.distribution();
+	}
+
+	/**
+	 * @brief Gets the number of passengers delivered to their destinations.
+	 *
+	 * @return The number of passengers, counting every member of a group, complete once simulate has returned.
+	 */
+	size_t getDeliveredCount() const {
+		return deliveredPassenger;
+	}
+
+	/**
+	 * @brief Gets the number of passengers who gave up waiting.
+	 *
+	 * @return The number of passengers.
+	 */
+	size_t getAbandonedCount() const {
+		return abandonedPassenger;
+	}
+
+	/**
+	 * @brief Gets the number of passengers who did not join a queue because it was too long.
+	 *
+	 * @return The number of passengers.
+	 */
+	size_t getBalkedCount() const {
+		return balkedPassenger;
+	}
+
+	/**
+	 * @brief Gets the share of passengers who abandoned or balked.
+	 *
+	 * @return The share between 0 and 1, or 0 if there are no passengers.
+	 */
+	double getAbandonmentRate() const {
+		return totalPassenger == 0 ? 0.0 : static_cast<double>(abandonedPassenger + balkedPassenger) / totalPassenger;
+	}
+
+	/**
+	 * @brief Gets the statistic of the time passengers waited before giving up.
+	 *
+	 * @return The statistic, complete once simulate has returned.
+	 */
+	const Statistic& getAbandonWaitStat() const {
+		return abandonWaitStat;
+	}
+
+	/**
+	 * @brief Adds a sink that receives every parking decision. Call it before simulate.
+	 *
+	 * @param sink The sink, owned by the building from now on.
+	 */
+	void addParkingSink(std::unique_ptr<ParkingSink> sink) {
+		parkingSinks.push_back(std::move(sink));
+	}
+
+	/**
+	 * @brief Gets the number of parking decisions and the floors cars ran to park.
+	 *
+	 * @return The tally, once simulate has returned.
+	 */
+	const ParkingTally& getParkingTally() const {
+		return parkingTally;
+	}
+
+	/**
+	 * @brief Gets the time the cars spent at stops, split into door movement and passenger transfer.
+	 *
+	 * @return The stop times, once simulate has returned.
+	 */
+	const StopTimeSink& getStopTimes() const {
+		return stopTimeSink;
+	}
+
+	/**
+	 * @brief Sets whether cars fly straight to the next floor where anything could happen, skipping the floors in between.
+	 *
+	 * @param enabled True for event-driven travel, false to let the policy decide at every floor.
+	 */
+	void setEventDrivenTravel(bool enabled) {
+		elevators.setEventDriven(enabled);
+	}
+
+	/**
+	 * @brief Runs one second of the simulation, for callers that drive the simulation themselves.
+	 *
+	 * Unlike simulate, nothing is logged per second and delivered passengers only go to the given sink,
+	 * not to the building's statistics.
+	 *
+	 * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+	 * @param policy The dispatch policy.
+	 * @param delivered The sink receiving passengers dropped off at their destination.
+	 */
+	template <typename Policy>
+	void step(Policy& policy, DeliverySink& delivered) {
+		advance(policy, delivered);
+		++currentTime;
+	}
+
+	/**
+	 * @brief Checks if every passenger of the trace has been delivered.
+	 *
+	 * @return True if nobody is waiting, riding or still to arrive, false otherwise.
+	 */
+	bool isFinished() const {
+		return allPassengerArrived();
+	}
+
+	/**
+	 * @brief Gets the floors of the building, e.g. to read hall calls and waiting counts.
+	 *
+	 * @return The floors.
+	 */
+	const FloorSet& getFloors() const {
+		return floors;
+	}
+
+	/**
+	 * @brief Gets the elevators of the building, e.g. to read car positions and loads.
+	 *
+	 * @return The elevators.
+	 */
+	const ElevatorBank& getElevators() const {
+		return elevators;
+	}
+
+	/**
+	 * @brief Gets the time at which the simulation ended.
+	 *
+	 * @return The time in seconds when the last passenger was delivered, once simulate has returned.
+	 */
+	int getElapsedTime() const {
+		return currentTime;
+	}
+
+	/**
+	 * @brief Gets the number of passengers delivered per hour of simulated time.
+	 *
+	 * @return The throughput, once simulate has returned.
+	 */
+	double getThroughput() const {
+		return currentTime == 0 ? 0.0 : 3600.0 * deliveredPassenger / currentTime;
+	}
+
+	/**
+	 * @brief Replaces the default energy model of the cars. Call it before simulate.
+	 *
+	 * @param model The masses, efficiencies and fixed costs of the cars.
+	 * @throw std::invalid_argument if the model is invalid, see EnergyModel::validate.
+	 */
+	void setEnergyModel(const EnergyModel& model) {
+		elevators.setEnergyModel(model);
+	}
+
+	/**
+	 * @brief Gets the energy all cars used.
+	 *
+	 * @return The energy split by cause, once simulate has returned.
+	 */
+	CarEnergy getEnergy() const {
+		return elevators.getTotalEnergy();
+	}
+
+	/**
+	 * @brief Gets the net energy used per passenger delivered.
+	 *
+	 * @return The energy in kWh, once simulate has returned.
+	 */
+	double getEnergyPerPassenger() const {
+		return deliveredPassenger == 0 ? 0.0 : elevators.getTotalEnergy().total() / deliveredPassenger;
+	}
+
+	/**
+	 * @brief Gets the number of passengers delivered per hour in the busiest five minutes of simulated time.
+	 *
+	 * @return The peak throughput, once simulate has returned.
+	 */
+	double getPeakThroughput() const {
+		return throughputSink.getPeakThroughput();
+	}
+
+	/**
+	 * @brief Simulates elevator behavior in the building with the reference full-sweep policy.
 	 *
 	 * This function simulates the movement of elevators and the arrival of passengers
 	 * until all passengers have arrived at their destinations.
 	 */
 	void simulate() {
-		auto file_logger = spdlog::basic_logger_mt(logFileName + "_adding_passengers", logFileLocation);
-		auto time_logger = spdlog::basic_logger_mt(logFileName + "_time_log", "logs/" + logFileName + "_time_log" + ".txt");
-		auto stat_logger = spdlog::basic_logger_mt(logFileName + "_stat_log", "logs/" + logFileName + "_stat_log" + ".txt");
+		FullSweepPolicy policy;
+		simulate(policy);
+	}
 
-		// keep updating until all passengers arrived
-		while (!allPassengerArrived()) {
-			// update passengers
-			while (!passengers.empty() && passengers.front().getStartTime() == currentTime) {
-				Floor& passengerStartFloor = floors[passengers.front().getStartFloor() - 1];
-				Passenger passenger = passengers.front();
-				passengerStartFloor.addWaitingPassenger(passenger);
-				passengers.pop();
-
-				// log passenger arrival
-				file_logger->info("Passenger {} arrived at floor {} at time {}", passenger.getPassengerID(), passengerStartFloor.getFloorNumber(), currentTime);
-			}
+	/**
+	 * @brief Simulates elevator behavior in the building with the given dispatch policy.
+	 *
+	 * This function simulates the movement of elevators and the arrival of passengers
+	 * until all passengers have arrived at their destinations.
+	 *
+	 * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+	 * @param policy The dispatch policy. It is passed by reference so its counters can be read afterwards.
+	 */
+	template <typename Policy>
+	void simulate(Policy& policy) {
+		simulate(policy, [](const Building&) { return false; });
+	}
 
-			// update elevators. Start elevator at different time to improve pickup passenger efficiency
+	/**
+	 * @brief Simulates elevator behavior with the given dispatch policy, stopping early once a condition holds.
+	 *
+	 * The condition is checked every ABORT_CHECK_INTERVAL seconds of simulated time. It lets a tuner drop a
+	 * run as soon as the statistics so far show it cannot beat the best run it already has.
+	 *
+	 * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+	 * @tparam AbortCondition A callable taking a const Building reference and returning true to stop.
+	 * @param policy The dispatch policy. It is passed by reference so its counters can be read afterwards.
+	 * @param shouldAbort The condition.
+	 * @return True if every passenger was delivered, false if the run was stopped early.
+	 */
+	template <typename Policy, typename AbortCondition>
+	bool simulate(Policy& policy, AbortCondition shouldAbort) {
+		auto time_logger = openSimulationLogger(logFileName + "_time_log", "logs/" + logFileName + "_time_log" + ".txt", quiet);
+		auto stat_logger = openSimulationLogger(logFileName + "_stat_log", "logs/" + logFileName + "_stat_log" + ".txt", quiet);
 
-			elevators[0].update(currentTime, NUM_OF_FLOORS, floors);
+		// delivered passengers are streamed to the sinks at drop-off time
+		StatisticSink statisticSink(travelTimeStat, waitTimeStat);
+		TimeLogSink timeLogSink(time_logger);
+		RetentionSink retentionSink(floors);
+		DeliveryPipeline deliveryPipeline;
+		deliveryPipeline.add(statisticSink);
+		deliveryPipeline.add(timeLogSink);
+		deliveryPipeline.add(throughputSink);
+		if (retainDeliveredPassengers) {
+			deliveryPipeline.add(retentionSink);
+		}
+		for (auto& sink : extraDeliverySinks) {
+			deliveryPipeline.add(*sink);
+		}
 
-			if (currentTime >= 100) {
-				elevators[1].update(currentTime, NUM_OF_FLOORS, floors);
-			}
-			if (currentTime >= 500) {
-				elevators[2].update(currentTime, NUM_OF_FLOORS, floors);
-			}
-			if (currentTime >= 700) {
-				elevators[3].update(currentTime, NUM_OF_FLOORS, floors);
-			}
+		// keep updating until all passengers arrived
+		while (!allPassengerArrived()) {
+			advance(policy, deliveryPipeline);
 
 			// log statistics
-			statLog(stat_logger);
+			if (!quiet) {
+				statLog(stat_logger);
+			}
 
 			// increment time
 			++currentTime;
+
+			if (currentTime % ABORT_CHECK_INTERVAL == 0 && shouldAbort(*this)) {
+				deliveredPassenger = deliveryPipeline.getDeliveredCount();
+				stat_logger->info("Simulation stopped early at time {}", currentTime);
+				return false;
+			}
 		} // end while
 
-		// put wait and travel time to statistic
-		for (int i = 0; i < NUM_OF_FLOORS; ++i) {
-			for (auto& passenger : floors.at(i).getDeliveredPassengers()) {
-				travelTimeStat.addNumber(passenger.getTravelTime());
-				waitTimeStat.addNumber(passenger.getWaitTime());
-				time_logger->info("Passenger {}: wait time {}, travel time {}", passenger.getPassengerID(), passenger.getWaitTime(), passenger.getTravelTime());
-				++deliveredPassenger;
+		deliveredPassenger = deliveryPipeline.getDeliveredCount();
+
+		// report how much memory the simulation containers used
+		stat_logger->info("Arena peak bytes: {}", arena.getPeakBytes());
+		stat_logger->info("Arena total bytes: {}", arena.getTotalBytes());
+		stat_logger->info("Stops: {}, door time: {} s, transfer time: {} s", stopTimeSink.getStopCount(), stopTimeSink.getDoorTime(), stopTimeSink.getTransferTime());
+		const CarEnergy energy = elevators.getTotalEnergy();
+		stat_logger->info("Energy: {} kWh ({} kWh per passenger), motoring {} kWh, regenerated {} kWh, starts {} kWh, standby {} kWh",
+			energy.total(), getEnergyPerPassenger(), energy.motoring, energy.regenerated, energy.startStop, energy.standby);
+		if (traffic) {
+			for (const TrafficRegime& regime : traffic->getTimeline()) {
+				stat_logger->info("Traffic regime from {} s: {}", regime.startTime, toString(regime.mode));
+			}
+		}
+		if (parkingPolicy) {
+			stat_logger->info("Parking decisions: {}, parking runs: {}, floors run to park: {}", parkingTally.getDecisionCount(),
+				parkingTally.getParkingRunCount(), parkingTally.getFloorsRun());
+		}
+		if (patienceEnabled) {
+			stat_logger->info("Abandoned: {} (mean wait before leaving {} s), balked: {}, abandonment rate: {}", abandonedPassenger,
+				abandonWaitStat.getAverage(), balkedPassenger, getAbandonmentRate());
+		}
+		if (journeys.isZoned()) {
+			stat_logger->info("Mean journey time: {} s, transfers between groups: {}", journeys.getJourneyTimeStat().getAverage(), journeys.getTransferCount());
+			for (size_t leg = 0; leg < journeys.getNumOfLegs(); ++leg) {
+				stat_logger->info("Leg {}: {} rides, mean wait {} s, mean travel {} s", leg + 1, journeys.getLegWaitStat(leg).getCount(),
+					journeys.getLegWaitStat(leg).getAverage(), journeys.getLegTravelStat(leg).getAverage());
 			}
 		}
 
 		// print statistics
-		std::cout << "\nAverage wait time: " << waitTimeStat.getAverage() << std::endl;
-		std::cout << "Average travel time: " << travelTimeStat.getAverage() << std::endl;
+		if (!quiet) {
+			std::cout << "\nAverage wait time: " << waitTimeStat.getAverage() << std::endl;
+			std::cout << "Average travel time: " << travelTimeStat.getAverage() << std::endl;
+			if (patienceEnabled) {
+				std::cout << "Abandonment rate: " << getAbandonmentRate() << std::endl;
+			}
+		}
 
 		// check if all passengers are delivered
-		if (totalPassenger != deliveredPassenger) {
+		if (totalPassenger != deliveredPassenger + abandonedPassenger + balkedPassenger) {
 			throw std::runtime_error("Not all passengers are delivered");
 		}
+		return true;
 	}
 
 private:
@@ -118,73 +716,180 @@ private:
 	const int ELEVATOR_SPEED; ///< Speed of the elevators (in seconds per floor).
 	const int ELEVATOR_STOPPING_TIME; ///< Time taken for the elevator to stop at a floor (in seconds).
 	int currentTime = 0; ///< Current simulation time.
-	std::vector<Floor> floors; ///< Vector of floors in the building.
-	std::vector<Elevator> elevators; ///< Vector of elevators in the building.
-	std::queue<Passenger> passengers; ///< Queue of passengers waiting to enter the building.
-	Statistic travelTimeStat; ///< Statistic for passenger travel times.
-	Statistic waitTimeStat; ///< Statistic for passenger wait times.
+	SimulationArena arena; ///< Memory for every simulation container. Declared first so it is released last.
+	FloorSet floors; ///< The floors in the building, with Floor objects only for busy floors.
+	ElevatorBank elevators; ///< The elevators in the building.
+	CarSchedule schedule; ///< When each car goes into service and where it parks.
+	std::queue<Passenger, std::pmr::deque<Passenger>> passengers{ std::pmr::deque<Passenger>(&arena) }; ///< Queue of passengers waiting to enter the building.
+	Statistic travelTimeStat{ false, &arena }; ///< Statistic for passenger travel times.
+	Statistic waitTimeStat{ false, &arena }; ///< Statistic for passenger wait times.
 
 	const std::string logFileName; ///< Name of the log file.
 	const std::string logFileLocation; ///< Location to save log file
+	const bool quiet; ///< Whether log files and console output are switched off.
+	std::shared_ptr<spdlog::logger> arrivalLogger; ///< Logger of passenger arrivals, opened on the first second simulated.
+	static constexpr int ABORT_CHECK_INTERVAL = 60; ///< Seconds of simulated time between checks of an abort condition.
+	static constexpr const char* TRACE_FILE_NAME = "Mod10_Assignment_Elevators.csv"; ///< Passenger trace read by default.
 
-	// For error checking
-	size_t totalPassenger = 0; ///< Total number of passengers.
-	size_t deliveredPassenger = 0; ///< Number of passengers delivered to their destinations.
+	bool retainDeliveredPassengers = false; ///< Whether delivered passengers are kept on their destination floor.
+	std::vector<std::unique_ptr<DeliverySink>> extraDeliverySinks; ///< Sinks added with addDeliverySink.
+	ThroughputSink throughputSink{ &arena }; ///< Counts deliveries per minute for the peak throughput.
+	StopTimeSink stopTimeSink; ///< Adds up the door and transfer time of every stop.
+	std::vector<std::unique_ptr<StopSink>> extraStopSinks; ///< Sinks added with addStopSink.
+	JourneySink journeys; ///< Splits trips into legs between the cars and the delivery sinks.
+	int doubleDeckLobby = 0; ///< The lobby split between the decks of double-deck cars, 0 if not split.
+	std::unique_ptr<ParkingPolicy> parkingPolicy; ///< Chooses the parking floors of idle cars, or nullptr for the fixed ones.
+	ParkingTally parkingTally; ///< Counts the parking decisions.
+	std::vector<std::unique_ptr<ParkingSink>> parkingSinks; ///< Sinks added with addParkingSink.
+	std::shared_ptr<spdlog::logger> parkingLogger; ///< Logger of parking decisions, opened on the first decision.
+	std::unique_ptr<TrafficClassifier> traffic; ///< Classifies the arriving traffic, or nullptr if detection is off.
+	bool patienceEnabled = false; ///< Whether passengers abandon and balk.
+	PatienceModel patience; ///< How long passengers wait and how long a queue they join.
+	std::mt19937 patienceRandom; ///< Draws the patience of each passenger.
+	std::weibull_distribution<double> patienceDistribution; ///< The patience of passengers, in seconds.
 
 	/**
-	 * @brief Initializes the floors in the building.
-	 *
-	 * This function initializes the floors in the building based on the specified number of floors.
+	 * @brief A passenger's patience running out.
+	 */
+	struct PatienceTimer {
+		FloorSet::WaitingHandle handle; ///< The passenger in the queue, stale once they board.
+		int joinTime; ///< The time the passenger joined the queue.
+	};
+	TimingWheel<PatienceTimer> patienceTimers{ 1024, &arena }; ///< The patience of every waiting passenger, by the time it runs out.
+	Statistic abandonWaitStat{ false, &arena }; ///< Statistic for the time passengers waited before giving up.
+
+	/**
+	 * @brief Gives the cars that ran out of work in this second a parking floor, and reports the decisions.
 	 */
-	void initalizeFloors() {
-		for (int i = 0; i < NUM_OF_FLOORS; ++i) {
-			floors.push_back(Floor(i + 1));
+	void parkIdleCars() {
+		for (int car : elevators.getParkingRequests()) {
+			ParkingEvent event{ car, currentTime, elevators.getCurrentFloor(car), parkingPolicy->chooseParkingFloor(elevators, car, currentTime) };
+			elevators.assignParkingFloor(car, event.toFloor);
+
+			parkingTally.record(event);
+			for (auto& sink : parkingSinks) {
+				sink->record(event);
+			}
+			if (!parkingLogger) {
+				parkingLogger = openSimulationLogger(logFileName + "_parking", "logs/" + logFileName + "_parking_log.txt", quiet);
+			}
+			parkingLogger->info("Car {} idle at floor {} at time {} parks at floor {}", car, event.fromFloor, currentTime, event.toFloor);
 		}
+		elevators.clearParkingRequests();
 	}
 
 	/**
-	 * @brief Initializes the elevators in the building.
+	 * @brief Moves a lobby trip to the upper lobby if its other floor is an odd number of floors above the lobby.
 	 *
-	 * This function initializes the elevators in the building based on the specified number of elevators.
+	 * @param passenger The arriving passenger.
+	 * @return The passenger, with the trip starting or ending at the lobby deck it uses.
 	 */
-	void initalizeElevators() {
-		for (int i = 0; i < NUM_OF_ELEVATORS; ++i) {
-			elevators.push_back(Elevator(i, ELEVATOR_SPEED, ELEVATOR_STOPPING_TIME, logFileName));
+	Passenger assignLobbyDeck(const Passenger& passenger) const {
+		const int upperLobby = doubleDeckLobby + 1;
+		const int start = passenger.getStartFloor();
+		const int end = passenger.getEndFloor();
+		if (doubleDeckLobby == 0) {
+			return passenger;
+		}
+		if (start == doubleDeckLobby && end > upperLobby && (end - doubleDeckLobby) % 2 == 1) {
+			return Passenger(passenger.getPassengerID(), passenger.getStartTime(), upperLobby, end, passenger.getGroupSize());
 		}
+		if (end == doubleDeckLobby && start > upperLobby && (start - doubleDeckLobby) % 2 == 1) {
+			return Passenger(passenger.getPassengerID(), passenger.getStartTime(), start, upperLobby, passenger.getGroupSize());
+		}
+		return passenger;
 	}
 
+	// For error checking
+	size_t totalPassenger = 0; ///< Total number of passengers.
+	size_t deliveredPassenger = 0; ///< Number of passengers delivered to their destinations.
+	size_t abandonedPassenger = 0; ///< Number of passengers who gave up waiting.
+	size_t balkedPassenger = 0; ///< Number of passengers who did not join a queue.
+
 	/**
-	 * @brief Initializes the passengers waiting to enter the building.
+	 * @brief Runs the current second of the simulation without moving the clock.
+	 *
+	 * Passengers due now and passengers changing groups join their floors, then the policy ticks and every
+	 * car in service is updated.
 	 *
-	 * This function reads passenger data from a CSV file and creates Passenger objects,
-	 * which are then added to the queue of waiting passengers.
+	 * @throw std::runtime_error if no car serves both floors of the next leg of an arriving passenger's trip.
+	 * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+	 * @param policy The dispatch policy.
+	 * @param delivered The sink receiving passengers dropped off at their destination.
 	 */
-	void initalizePassengers() {
-		std::ifstream inputFile("Mod10_Assignment_Elevators.csv"); // open csv
-		std::string line;
-		int startFloor = 1;
-		int endFloor = 1;
-		int startTime = 1;
-		int id = 1;
+	template <typename Policy>
+	void advance(Policy& policy, DeliverySink& delivered) {
+		if (!arrivalLogger) {
+			arrivalLogger = openSimulationLogger(logFileName + "_adding_passengers", logFileLocation, quiet);
+		}
 
-		std::getline(inputFile, line); // skip first line)
+		auto join = [&](Passenger& passenger) {
+			if (!elevators.canAnyCarry(passenger.getStartFloor(), passenger.getEndFloor())) {
+				throw std::runtime_error("No car serves the trip of passenger " + std::to_string(passenger.getPassengerID()));
+			}
+			if (patienceEnabled && patience.balks(floors.getWaitingCount(passenger.getStartFloor()))) {
+				balkedPassenger += static_cast<size_t>(passenger.getGroupSize());
+				arrivalLogger->info("Passenger {} balked at floor {} at time {}", passenger.getPassengerID(), passenger.getStartFloor(), currentTime);
+				return;
+			}
+			FloorSet::WaitingHandle handle;
+			if (floors.addWaitingPassenger(passenger, handle)) {
+				policy.onHallCall(elevators, floors, passenger.getStartFloor(), passenger.getDirection());
+			}
+			policy.onPassengerArrival(elevators, floors, passenger, currentTime);
+			if (parkingPolicy) {
+				parkingPolicy->recordCall(passenger.getStartFloor(), currentTime);
+			}
 
-		// read each line and create passenger object and push to queue
-		while (std::getline(inputFile, line)) {
-			std::stringstream ss(line);
-			std::string token;
-			while (std::getline(ss, token, ',')) {
-				startTime = std::stoi(token);
-				std::getline(ss, token, ',');
-				startFloor = std::stoi(token);
-				std::getline(ss, token, ',');
-				endFloor = std::stoi(token);
+			// log passenger arrival
+			if (passenger.getGroupSize() == 1) {
+				arrivalLogger->info("Passenger {} arrived at floor {} at time {}", passenger.getPassengerID(), passenger.getStartFloor(), currentTime);
 			}
-			Passenger passenger(id, startTime, startFloor, endFloor);
-			passengers.push(passenger);
-			++id;
+			else {
+				arrivalLogger->info("Passenger {} arrived at floor {} at time {} as a group of {}", passenger.getPassengerID(), passenger.getStartFloor(),
+					currentTime, passenger.getGroupSize());
+			}
+			if (patienceEnabled) {
+				const int wait = PatienceModel::draw(patienceRandom, patienceDistribution);
+				patienceTimers.schedule(currentTime + wait, PatienceTimer{ handle, currentTime });
+			}
+		};
+
+		// passengers whose patience ran out leave, unless a car picked them up first, which left their timer stale
+		patienceTimers.expire(currentTime, [&](const PatienceTimer& timer) {
+			std::optional<Passenger> left;
+			if (!floors.abandon(timer.handle, [&](const Passenger& passenger) { left = passenger; })) {
+				return;
+			}
+			abandonedPassenger += static_cast<size_t>(left->getGroupSize());
+			abandonWaitStat.addNumber(currentTime - timer.joinTime, static_cast<size_t>(left->getGroupSize()));
+			policy.onAbandon(elevators, floors, *left);
+			arrivalLogger->info("Passenger {} left floor {} at time {} after waiting {} s", left->getPassengerID(), left->getStartFloor(),
+				currentTime, currentTime - timer.joinTime);
+		});
+
+		// update passengers
+		while (!passengers.empty() && passengers.front().getStartTime() == currentTime) {
+			Passenger passenger = journeys.startJourney(assignLobbyDeck(passengers.front()));
+			passengers.pop();
+			if (traffic) {
+				traffic->record(passenger.getStartFloor(), passenger.getEndFloor(), currentTime, passenger.getGroupSize());
+			}
+			join(passenger);
 		}
-		inputFile.close();
+		journeys.joinTransfers(currentTime, join);
+		if (traffic && traffic->update(currentTime)) {
+			policy.onTrafficModeChange(elevators, floors, traffic->getMode());
+			if (parkingPolicy) {
+				parkingPolicy->onTrafficModeChange(traffic->getMode());
+			}
+		}
+		policy.onTick(elevators, floors, currentTime);
+
+		// update elevators. The car schedule starts them at different times to improve pickup passenger efficiency
+		journeys.setDownstream(delivered);
+		elevators.update(currentTime, schedule.getNumOfActiveCars(currentTime), floors, journeys, policy);
+		parkIdleCars();
 	}
 
 	/**
@@ -195,22 +900,20 @@ private:
 	 *
 	 * @return True if all passengers have arrived, false otherwise.
 	 */
-	bool allPassengerArrived() {
+	bool allPassengerArrived() const {
 		// check all floors for waiting passengers
-		for (int i = 0; i < NUM_OF_FLOORS; ++i) {
-			if (floors[i].hasWaitingPassengers()) {
-				return false;
-			}
+		if (floors.hasWaitingPassengers()) {
+			return false;
 		}
 		// check all elevators for passengers
 		for (int i = 0; i < NUM_OF_ELEVATORS; ++i) {
-			if (elevators[i].hasPassengers()) {
+			if (elevators.hasPassengers(i)) {
 				return false;
 			}
 		}
 
-		// check queue has passengers
-		return passengers.empty();
+		// check queue has passengers, and nobody is on their way between two legs
+		return passengers.empty() && !journeys.hasPendingTransfers();
 	}
 
 	/**
@@ -232,24 +935,15 @@ private:
 		int deliveredPassengerCount = 0;
 		int averageWaitTime = 0;
 
-		// Iterate through each floor to count waiting passengers
-		for (int i = 0; i < NUM_OF_FLOORS; ++i) {
-			if (!floors[i].getWaitingPassengers().empty()) {
-				waitingPassengerCount += floors[i].getWaitingPassengers().size();
-			}
-		}
+		// Waiting passengers are counted by the floor set as they arrive and board
+		waitingPassengerCount = static_cast<int>(floors.getWaitingCount());
 
-		// Iterate through each floor to count delivered passengers and calculate average wait time
-		for (int i = 0; i < NUM_OF_FLOORS; ++i) {
-			deliveredPassengerCount += floors[i].getDeliveredPassengers().size();
-			for (auto& passenger : floors.at(i).getDeliveredPassengers()) {
-				averageWaitTime += passenger.getWaitTime();
-			}
-		}
+		// Delivered passengers and their wait times are already summed by the statistics sink
+		deliveredPassengerCount = static_cast<int>(waitTimeStat.getCount());
 
 		// Calculate average wait time if there are delivered passengers
 		if (deliveredPassengerCount != 0) {
-			averageWaitTime /= deliveredPassengerCount;
+			averageWaitTime = static_cast<int>(waitTimeStat.getSum() / deliveredPassengerCount);
 		}
 
 		// Log number of waiting passengers and average wait time
@@ -0,0 +1,100 @@
+/**
+ * @file CarKinematics.h
+ * @brief Declaration and implementation of the CarKinematics class.
+ *
+ * The CarKinematics class models how a real car travels: it accelerates under a jerk limit, cruises at its
+ * rated speed, and brakes the same way, so a long express run costs far less per floor than a one-floor hop.
+ * The flight time of a run of d floors from rest to rest is computed in closed form for a jerk-limited
+ * (S-curve) profile, falling back to a lower peak speed when the run is too short to reach the rated speed.
+ *
+ * The simulation only needs the flight time of every possible run, so flightTimeTable computes them all
+ * once, rounded to whole seconds, and the update kernel looks them up.
+ */
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+class CarKinematics {
+public:
+	/**
+	 * @brief Constructs the kinematic model of a car.
+	 *
+	 * @param floorHeight The distance between two floors, in meters.
+	 * @param maxSpeed The rated speed, in meters per second.
+	 * @param acceleration The largest acceleration and deceleration, in meters per second squared.
+	 * @param jerk The largest rate of change of the acceleration, in meters per second cubed.
+	 * @throw std::invalid_argument if a parameter is not positive.
+	 */
+	CarKinematics(double floorHeight, double maxSpeed, double acceleration, double jerk)
+		: floorHeight(floorHeight), maxSpeed(maxSpeed), acceleration(acceleration), jerk(jerk) {
+		if (!(floorHeight > 0) || !(maxSpeed > 0) || !(acceleration > 0) || !(jerk > 0)) {
+			throw std::invalid_argument("Floor height, speed, acceleration and jerk must be positive");
+		}
+	}
+
+	/**
+	 * @brief Gets the time a car takes to travel a number of floors, starting and ending at rest.
+	 *
+	 * @param numOfFloors The length of the run in floors.
+	 * @return The flight time in seconds, 0 for a run of no floors.
+	 */
+	double flightTime(int numOfFloors) const {
+		if (numOfFloors <= 0) {
+			return 0.0;
+		}
+
+		double distance = numOfFloors * floorHeight;
+		if (distance >= brakingDistance(maxSpeed) * 2) {
+			// reach the rated speed and cruise for the rest of the run
+			double peakAcceleration = std::min(acceleration, std::sqrt(maxSpeed * jerk));
+			return distance / maxSpeed + maxSpeed / peakAcceleration + peakAcceleration / jerk;
+		}
+
+		// too short to reach the rated speed: find the peak speed whose speed-up and braking cover the run
+		double low = 0.0;
+		double high = maxSpeed;
+		for (int i = 0; i < 60; ++i) {
+			double mid = (low + high) / 2;
+			(brakingDistance(mid) * 2 < distance ? low : high) = mid;
+		}
+		double peakAcceleration = std::min(acceleration, std::sqrt(low * jerk));
+		return 2 * (low / peakAcceleration + peakAcceleration / jerk);
+	}
+
+	/**
+	 * @brief Precomputes the flight time of every run in a building.
+	 *
+	 * Times are rounded to whole seconds, and every extra floor adds at least one second, since the
+	 * simulation moves in steps of one second.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @return The flight time of a run of d floors at index d, for d from 0 to numOfFloors - 1.
+	 */
+	std::vector<int> flightTimeTable(int numOfFloors) const {
+		std::vector<int> table(std::max(1, numOfFloors), 0);
+		for (int floors = 1; floors < numOfFloors; ++floors) {
+			table[floors] = std::max(table[floors - 1] + 1, static_cast<int>(std::lround(flightTime(floors))));
+		}
+		return table;
+	}
+
+private:
+	const double floorHeight; // The distance between two floors, in meters.
+	const double maxSpeed; // The rated speed, in meters per second.
+	const double acceleration; // The largest acceleration, in meters per second squared.
+	const double jerk; // The largest rate of change of the acceleration, in meters per second cubed.
+
+	/**
+	 * @brief Gets the distance a car covers speeding up from rest to a speed, which is also the distance it needs to brake.
+	 *
+	 * @param speed The speed to reach, in meters per second.
+	 * @return The distance in meters.
+	 */
+	double brakingDistance(double speed) const {
+		double peakAcceleration = std::min(acceleration, std::sqrt(speed * jerk));
+		return speed * (speed / peakAcceleration + peakAcceleration / jerk) / 2;
+	}
+};
@@ -0,0 +1,248 @@
+/**
+ * @file CarMask.h
+ * @brief Declaration and implementation of the CarMasks table and the CarMask view.
+ *
+ * A CarMasks table holds a set of cars per row, e.g. the cars serving each floor, with one bit per car in
+ * as many 64-bit words as the bank needs, so a membership test is one bit test whatever the size of the bank.
+ * A CarMask is a read-only view of one row; a view without a row holds every car.
+ */
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+
+class CarMask {
+public:
+	/**
+	 * @brief Constructs a view holding every car.
+	 */
+	CarMask() = default;
+
+	/**
+	 * @brief Constructs a view of a row of a CarMasks table.
+	 *
+	 * @param words The words of the row, bit car % 64 of word car / 64 set for every car in the set.
+	 * @param numOfWords The number of words of the row.
+	 */
+	CarMask(const std::uint64_t* words, size_t numOfWords) : words(words), numOfWords(numOfWords) {
+	}
+
+	/**
+	 * @brief Checks if a car is in the set.
+	 *
+	 * @param car The index of the elevator.
+	 * @return True if the car is in the set, false otherwise.
+	 */
+	bool contains(int car) const {
+		return words == nullptr || ((words[car >> 6] >> (car & 63)) & 1u);
+	}
+
+	/**
+	 * @brief Gets the lowest car in the set.
+	 *
+	 * @return The index of the car, or -1 if the set is empty.
+	 */
+	int first() const {
+		if (words == nullptr) {
+			return 0;
+		}
+		for (size_t word = 0; word < numOfWords; ++word) {
+			if (words[word] != 0) {
+				int bit = 0;
+				while (((words[word] >> bit) & 1u) == 0) {
+					++bit;
+				}
+				return static_cast<int>(word) * 64 + bit;
+			}
+		}
+		return -1;
+	}
+
+private:
+	const std::uint64_t* words = nullptr; // The words of the row, or nullptr for every car.
+	size_t numOfWords = 0; // The number of words of the row.
+};
+
+class CarMasks {
+public:
+	/**
+	 * @brief Constructs a table without rows.
+	 *
+	 * @param resource The memory resource used for the words.
+	 */
+	explicit CarMasks(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: bits(resource) {
+	}
+
+	/**
+	 * @brief Constructs a table of sets of a bank's cars.
+	 *
+	 * @param numOfRows The number of rows.
+	 * @param numOfCars The number of elevators in the bank.
+	 * @param full True to start every row with every car, false to start it empty.
+	 * @param resource The memory resource used for the words.
+	 */
+	CarMasks(int numOfRows, int numOfCars, bool full, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: bits(resource) {
+		reset(numOfRows, numOfCars, full);
+	}
+
+	/**
+	 * @brief Resizes the table, giving every row every car or none.
+	 *
+	 * @param numOfRows The number of rows.
+	 * @param numOfCars The number of elevators in the bank.
+	 * @param full True to give every row every car, false to empty it.
+	 */
+	void reset(int numOfRows, int numOfCars, bool full) {
+		rows = numOfRows;
+		cars = numOfCars;
+		wordsPerRow = static_cast<size_t>(numOfCars + 63) / 64;
+		bits.assign(static_cast<size_t>(numOfRows) * wordsPerRow, 0);
+		if (full) {
+			for (int row = 0; row < numOfRows; ++row) {
+				for (int car = 0; car < numOfCars; ++car) {
+					assign(row, car, true);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Checks if the table has no rows.
+	 *
+	 * @return True if there are no rows, false otherwise.
+	 */
+	bool empty() const {
+		return rows == 0;
+	}
+
+	/**
+	 * @brief Gets the number of rows.
+	 *
+	 * @return The number of rows.
+	 */
+	int getNumOfRows() const {
+		return rows;
+	}
+
+	/**
+	 * @brief Gets the number of cars each row has a bit for.
+	 *
+	 * @return The number of elevators in the bank.
+	 */
+	int getNumOfCars() const {
+		return cars;
+	}
+
+	/**
+	 * @brief Gets a view of a row.
+	 *
+	 * @param row The index of the row.
+	 * @return The set of cars of the row, valid until the table is reset.
+	 */
+	CarMask operator[](int row) const {
+		return CarMask(bits.data() + static_cast<size_t>(row) * wordsPerRow, wordsPerRow);
+	}
+
+	/**
+	 * @brief Checks if a car is in the set of a row.
+	 *
+	 * @param row The index of the row.
+	 * @param car The index of the elevator.
+	 * @return True if the car is in the set, false otherwise.
+	 */
+	bool test(int row, int car) const {
+		return (bits[index(row, car)] >> (car & 63)) & 1u;
+	}
+
+	/**
+	 * @brief Adds a car to or removes it from the set of a row.
+	 *
+	 * @param row The index of the row.
+	 * @param car The index of the elevator.
+	 * @param value True to add the car, false to remove it.
+	 */
+	void assign(int row, int car, bool value) {
+		std::uint64_t mask = std::uint64_t{ 1 } << (car & 63);
+		std::uint64_t& word = bits[index(row, car)];
+		word = (word & ~mask) | (value ? mask : 0);
+	}
+
+	/**
+	 * @brief Empties the set of a row.
+	 *
+	 * @param row The index of the row.
+	 */
+	void clear(int row) {
+		std::fill_n(bits.begin() + static_cast<std::ptrdiff_t>(row) * wordsPerRow, wordsPerRow, 0);
+	}
+
+	/**
+	 * @brief Adds the cars in both of two rows of another table with as many cars to the set of a row.
+	 *
+	 * @param row The index of the row to add to.
+	 * @param other The table to take the cars from, which may be this one.
+	 * @param first The index of the first row of other.
+	 * @param second The index of the second row of other.
+	 */
+	void addBoth(int row, const CarMasks& other, int first, int second) {
+		std::uint64_t* target = bits.data() + static_cast<size_t>(row) * wordsPerRow;
+		const std::uint64_t* a = other.bits.data() + static_cast<size_t>(first) * wordsPerRow;
+		const std::uint64_t* b = other.bits.data() + static_cast<size_t>(second) * wordsPerRow;
+		for (size_t word = 0; word < wordsPerRow; ++word) {
+			target[word] |= a[word] & b[word];
+		}
+	}
+
+	/**
+	 * @brief Checks if two rows hold the same cars.
+	 *
+	 * @param first The index of the first row.
+	 * @param second The index of the second row.
+	 * @return True if the sets are equal, false otherwise.
+	 */
+	bool equals(int first, int second) const {
+		const std::uint64_t* a = bits.data() + static_cast<size_t>(first) * wordsPerRow;
+		const std::uint64_t* b = bits.data() + static_cast<size_t>(second) * wordsPerRow;
+		return std::equal(a, a + wordsPerRow, b);
+	}
+
+	/**
+	 * @brief Checks if any car is in the sets of both of two rows.
+	 *
+	 * @param first The index of the first row.
+	 * @param second The index of the second row.
+	 * @return True if a car is in both sets, false otherwise.
+	 */
+	bool intersects(int first, int second) const {
+		const std::uint64_t* a = bits.data() + static_cast<size_t>(first) * wordsPerRow;
+		const std::uint64_t* b = bits.data() + static_cast<size_t>(second) * wordsPerRow;
+		for (size_t word = 0; word < wordsPerRow; ++word) {
+			if ((a[word] & b[word]) != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	std::pmr::vector<std::uint64_t> bits; // The words of every row, wordsPerRow per row.
+	int rows = 0; // The number of rows.
+	int cars = 0; // The number of cars each row has a bit for.
+	size_t wordsPerRow = 0; // The number of 64-bit words of one row.
+
+	/**
+	 * @brief Gets the index of the word holding the bit of a car in a row.
+	 *
+	 * @param row The index of the row.
+	 * @param car The index of the elevator.
+	 * @return The index into bits.
+	 */
+	size_t index(int row, int car) const {
+		return static_cast<size_t>(row) * wordsPerRow + static_cast<size_t>(car >> 6);
+	}
+};
@@ -0,0 +1,123 @@
+/**
+ * @file CarSchedule.h
+ * @brief Declaration and implementation of the CarSchedule class.
+ *
+ * The CarSchedule class says when each car of a building goes into service and where it parks.
+ * Cars go into service in index order, so the cars in service at any time are always cars 0 to n - 1,
+ * which is what the ElevatorBank update kernel and the dispatch policies expect.
+ *
+ * A car starts the simulation at its parking floor, and a car that runs out of work under LOOK dispatch
+ * returns there. Parking floor 0 means the car has no parking floor: it starts at floor 1 and stays
+ * wherever it runs out of work.
+ */
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+class CarSchedule {
+public:
+	static constexpr int NO_PARKING = 0; /**< Parking floor of a car that stays where it runs out of work. */
+
+	/**
+	 * @brief Constructs a schedule from the start time and parking floor of every car.
+	 *
+	 * @param startTimes The time in seconds each car goes into service, in non-decreasing order.
+	 * @param parkingFloors The parking floor of each car, or NO_PARKING.
+	 * @throw std::invalid_argument if the lists are empty or differ in size, a start time is negative or
+	 *        smaller than the one before it, or a parking floor is negative.
+	 */
+	CarSchedule(std::vector<int> startTimes, std::vector<int> parkingFloors)
+		: startTimes(std::move(startTimes)), parkingFloors(std::move(parkingFloors)) {
+		if (this->startTimes.empty() || this->startTimes.size() != this->parkingFloors.size()) {
+			throw std::invalid_argument("A car schedule needs one start time and one parking floor per car");
+		}
+		for (size_t car = 0; car < this->startTimes.size(); ++car) {
+			if (this->startTimes[car] < 0 || (car > 0 && this->startTimes[car] < this->startTimes[car - 1])) {
+				throw std::invalid_argument("Car " + std::to_string(car) + " must not start before the car ahead of it");
+			}
+			if (this->parkingFloors[car] < 0) {
+				throw std::invalid_argument("Car " + std::to_string(car) + " has a negative parking floor");
+			}
+		}
+	}
+
+	/**
+	 * @brief Creates the schedule the simulation has always used, generalized to any number of cars.
+	 *
+	 * Cars 0 to 3 start at 0, 100, 500 and 700 seconds, and every further car 200 seconds after the one before it.
+	 * No car has a parking floor.
+	 *
+	 * @param numOfCars The number of cars.
+	 * @return The schedule.
+	 */
+	static CarSchedule staggered(int numOfCars) {
+		const int offsets[] = { 0, 100, 500, 700 };
+		std::vector<int> startTimes;
+		for (int car = 0; car < numOfCars; ++car) {
+			startTimes.push_back(car < 4 ? offsets[car] : offsets[3] + 200 * (car - 3));
+		}
+		std::vector<int> parkingFloors(startTimes.size(), NO_PARKING);
+		return CarSchedule(std::move(startTimes), std::move(parkingFloors));
+	}
+
+	/**
+	 * @brief Gets the number of cars in the schedule.
+	 *
+	 * @return The number of cars.
+	 */
+	int size() const {
+		return static_cast<int>(startTimes.size());
+	}
+
+	/**
+	 * @brief Gets the time a car goes into service.
+	 *
+	 * @param car The index of the car.
+	 * @return The start time in seconds.
+	 */
+	int getStartTime(int car) const {
+		return startTimes[car];
+	}
+
+	/**
+	 * @brief Gets the parking floor of a car.
+	 *
+	 * @param car The index of the car.
+	 * @return The parking floor, or NO_PARKING.
+	 */
+	int getParkingFloor(int car) const {
+		return parkingFloors[car];
+	}
+
+	/**
+	 * @brief Gets the number of cars in service at a time.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @return The number of cars, counted from car 0, that have started.
+	 */
+	int getNumOfActiveCars(int currentTime) const {
+		return static_cast<int>(std::upper_bound(startTimes.begin(), startTimes.end(), currentTime) - startTimes.begin());
+	}
+
+	/**
+	 * @brief Formats the schedule as one "car: start time, parking floor" entry per car.
+	 *
+	 * @return The schedule as text.
+	 */
+	std::string toString() const {
+		std::string text;
+		for (size_t car = 0; car < startTimes.size(); ++car) {
+			text += (car == 0 ? "" : "; ") + std::to_string(car) + ": start " + std::to_string(startTimes[car])
+				+ "s, park " + (parkingFloors[car] == NO_PARKING ? std::string("none") : std::to_string(parkingFloors[car]));
+		}
+		return text;
+	}
+
+private:
+	std::vector<int> startTimes; /**< The time each car goes into service, in seconds. */
+	std::vector<int> parkingFloors; /**< The parking floor of each car, or NO_PARKING. */
+};
@@ -0,0 +1,59 @@
+/**
+ * @file CarSpec.h
+ * @brief Declaration and implementation of the CarSpec struct.
+ *
+ * A CarSpec describes one car of a mixed fleet: its time per floor, its stopping time, how many passengers
+ * it carries and which floors it serves. Local, express, shuttle and service cars differ only in these
+ * values, and in the number of decks: a double-deck car has two stacked cabs that stand at two adjacent
+ * floors in one stop. The bank turns the served floors into one bitmask of cars per floor, so checking
+ * whether a car serves a floor is a single bit test however the fleet is mixed.
+ */
+
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+struct CarSpec {
+	int speed = 10; // The time the car takes to move between floors, in seconds.
+	int stopTime = 2; // The time the car takes to stop at a floor, in seconds.
+	int capacity = 8; // The maximum number of passengers in each deck of the car.
+	std::vector<int> servedFloors; // The floors the car stops at, every floor if empty.
+	int decks = 1; // The number of decks, 2 for a double-deck car.
+
+	/**
+	 * @brief Checks the specification against a building.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @throw std::invalid_argument if the speed, stopping time or capacity is less than 1, or the car has neither 1 nor 2 decks.
+	 * @throw std::out_of_range if a served floor is not in the building.
+	 */
+	void validate(int numOfFloors) const {
+		if (speed < 1 || stopTime < 1 || capacity < 1) {
+			throw std::invalid_argument("Car speed, stopping time and capacity must be at least 1");
+		}
+		if (decks != 1 && decks != 2) {
+			throw std::invalid_argument("A car has one or two decks");
+		}
+		for (int floorNumber : servedFloors) {
+			if (floorNumber < 1 || floorNumber > numOfFloors) {
+				throw std::out_of_range("Served floor " + std::to_string(floorNumber) + " is not in the building");
+			}
+		}
+	}
+
+	/**
+	 * @brief Gets a list of floors from first to last, both included.
+	 *
+	 * @param first The lowest floor.
+	 * @param last The highest floor.
+	 * @return The floors, to build a served-floor list from.
+	 */
+	static std::vector<int> floorRange(int first, int last) {
+		std::vector<int> range;
+		for (int floorNumber = first; floorNumber <= last; ++floorNumber) {
+			range.push_back(floorNumber);
+		}
+		return range;
+	}
+};
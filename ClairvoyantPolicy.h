@@ -0,0 +1,134 @@
+/**
+ * @file ClairvoyantPolicy.h
+ * @brief Declaration and implementation of the ClairvoyantPolicy class.
+ *
+ * The ClairvoyantPolicy class is an offline policy: it is given the whole passenger trace in advance.
+ * Cars move with LOOK dispatch and answer hall calls with the nearest-car rule of LookPolicy, but a car
+ * with nothing to do does not wait for a call. Of the passengers due to arrive within the look-ahead
+ * horizon that no other car has claimed, it claims the one whose floor is nearest, and moves there before
+ * they arrive. A horizon of 0 gives plain LOOK dispatch with the nearest-car rule. It cannot be used online and serves as a reference for what future knowledge is worth.
+ */
+
+#pragma once
+#include "DispatchPolicy.h"
+#include "ElevatorBank.h"
+#include "FloorSet.h"
+#include "Passenger.h"
+#include "ElevatorState.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+class ClairvoyantPolicy : public LookDispatch<ClairvoyantPolicy> {
+public:
+	/**
+	 * @brief Constructs a ClairvoyantPolicy for a trace.
+	 *
+	 * @param trace The passengers of the simulation, in order of arrival. It must outlive the policy.
+	 * @param horizon How far ahead, in seconds, an idle car looks for a passenger to meet.
+	 * @throw std::invalid_argument if horizon is negative.
+	 */
+	ClairvoyantPolicy(const std::vector<Passenger>& trace, int horizon) : trace(trace), horizon(horizon) {
+		if (horizon < 0) {
+			throw std::invalid_argument("Look-ahead horizon cannot be negative");
+		}
+	}
+
+	/**
+	 * @brief Checks if no other active car that can carry the waiting passengers is closer to a hall call, breaking ties by car index.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return True if the car is the nearest to the call, false otherwise.
+	 */
+	bool answersHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return isNearestActiveCar(bank, car, floorNumber, floors.getHallCallCars(floorNumber, direction));
+	}
+
+	/**
+	 * @brief Moves past the passengers that have arrived, so the look-ahead starts at the next arrival.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void onTick(const ElevatorBank& bank, const FloorSet& floors, int currentTime) {
+		now = currentTime;
+		while (next < trace.size() && trace[next].getStartTime() <= currentTime) {
+			++next;
+		}
+		if (claims.empty()) {
+			claims.assign(bank.size(), NO_CLAIM);
+		}
+	}
+
+	/**
+	 * @brief Chooses the next move of a car.
+	 *
+	 * A car with work follows LOOK dispatch. A car without work heads for the passenger it has claimed,
+	 * claiming one first if it can, and otherwise parks like any LOOK car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return MOVING_UP, MOVING_DOWN, or STOPPED to wait at the current floor.
+	 */
+	ElevatorState nextMove(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		ElevatorDirection direction = bank.getDirection(car);
+		if (claims.empty() || hasWorkAhead(bank, car, floors, direction) || hasWorkAhead(bank, car, floors, opposite(direction))) {
+			if (!claims.empty()) {
+				claims[car] = NO_CLAIM;
+			}
+			return LookDispatch<ClairvoyantPolicy>::nextMove(bank, car, floors);
+		}
+
+		// keep a claim on a passenger who has not arrived yet, otherwise claim the nearest unclaimed arrival the car can carry
+		if (claims[car] == NO_CLAIM || claims[car] < next) {
+			claims[car] = NO_CLAIM;
+			int bestDistance = 0;
+			for (size_t i = next; i < trace.size() && trace[i].getStartTime() <= now + horizon; ++i) {
+				if (!bank.canCarry(car, trace[i].getStartFloor(), trace[i].getEndFloor())) {
+					continue;
+				}
+				int distance = std::abs(trace[i].getStartFloor() - bank.getCurrentFloor(car));
+				if ((claims[car] == NO_CLAIM || distance < bestDistance) && std::find(claims.begin(), claims.end(), i) == claims.end()) {
+					claims[car] = i;
+					bestDistance = distance;
+				}
+			}
+		}
+		if (claims[car] == NO_CLAIM) {
+			return LookDispatch<ClairvoyantPolicy>::nextMove(bank, car, floors);
+		}
+
+		int target = trace[claims[car]].getStartFloor();
+		if (target == bank.getCurrentFloor(car)) {
+			return ElevatorState::STOPPED;
+		}
+		return moveTowards(target > bank.getCurrentFloor(car) ? ElevatorDirection::UP : ElevatorDirection::DOWN);
+	}
+
+	/**
+	 * @brief Gets the floor of the passenger a car has claimed, so event-driven travel stops there.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @return The start floor of the claimed passenger, or 0 if the car has no claim.
+	 */
+	int flightWaypoint(const ElevatorBank& bank, int car) {
+		return claims.empty() || claims[car] == NO_CLAIM ? 0 : trace[claims[car]].getStartFloor();
+	}
+
+private:
+	static constexpr size_t NO_CLAIM = static_cast<size_t>(-1); // Marks a car without a claimed passenger.
+
+	const std::vector<Passenger>& trace; // The passengers of the simulation, in order of arrival.
+	const int horizon; // How far ahead an idle car looks, in seconds.
+	size_t next = 0; // Index in the trace of the first passenger who has not arrived yet.
+	int now = 0; // The current simulation time in seconds.
+	std::vector<size_t> claims; // Index in the trace of the passenger each car is heading for, or NO_CLAIM.
+};
@@ -0,0 +1,222 @@
+/**
+ * @file DeliverySink.h
+ * @brief Declaration and implementation of the delivery sinks.
+ *
+ * A DeliverySink receives every passenger at the moment an elevator drops them off at their destination.
+ * Sinks replace the old practice of keeping every delivered passenger on its destination floor until the end
+ * of the simulation, so memory use no longer grows with the number of trips.
+ *
+ * A delivered record may be a group (see Passenger.h); the counting sinks count each of its members.
+ */
+
+#pragma once
+#include "Passenger.h"
+#include "Statistic.h"
+#include "FloorSet.h"
+#include "spdlog/spdlog.h"
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <string>
+
+class DeliverySink {
+public:
+	virtual ~DeliverySink() = default;
+
+	/**
+	 * @brief Receives a passenger that has just arrived at their destination floor.
+	 *
+	 * @param passenger The delivered passenger, with wait and travel time already calculated.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	virtual void deliver(const Passenger& passenger, int currentTime) = 0;
+};
+
+/**
+ * @brief Forwards every delivered passenger to a list of sinks, in the order they were added.
+ *
+ * The pipeline does not own its sinks.
+ */
+class DeliveryPipeline : public DeliverySink {
+public:
+	/**
+	 * @brief Adds a sink to the end of the pipeline.
+	 *
+	 * @param sink The sink to add. It must outlive the pipeline.
+	 */
+	void add(DeliverySink& sink) {
+		sinks.push_back(&sink);
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		for (auto sink : sinks) {
+			sink->deliver(passenger, currentTime);
+		}
+		deliveredCount += static_cast<size_t>(passenger.getGroupSize());
+	}
+
+	/**
+	 * @brief Gets the number of passengers delivered through the pipeline.
+	 *
+	 * @return The number of delivered passengers.
+	 */
+	size_t getDeliveredCount() const {
+		return deliveredCount;
+	}
+
+private:
+	std::vector<DeliverySink*> sinks; // The sinks receiving delivered passengers.
+	size_t deliveredCount = 0; // The number of delivered passengers.
+};
+
+/**
+ * @brief Feeds wait and travel times into running statistics.
+ */
+class StatisticSink : public DeliverySink {
+public:
+	/**
+	 * @brief Constructs a StatisticSink.
+	 *
+	 * @param travelTimeStat The statistic receiving travel times.
+	 * @param waitTimeStat The statistic receiving wait times.
+	 */
+	StatisticSink(Statistic& travelTimeStat, Statistic& waitTimeStat)
+		: travelTimeStat(travelTimeStat), waitTimeStat(waitTimeStat) {
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		travelTimeStat.addNumber(passenger.getTravelTime(), static_cast<size_t>(passenger.getGroupSize()));
+		waitTimeStat.addNumber(passenger.getWaitTime(), static_cast<size_t>(passenger.getGroupSize()));
+	}
+
+private:
+	Statistic& travelTimeStat; // The statistic receiving travel times.
+	Statistic& waitTimeStat; // The statistic receiving wait times.
+};
+
+/**
+ * @brief Counts deliveries per minute to find the busiest stretch of the simulation.
+ */
+class ThroughputSink : public DeliverySink {
+public:
+	/**
+	 * @brief Constructs a ThroughputSink.
+	 *
+	 * @param resource The memory resource used for the counts.
+	 */
+	explicit ThroughputSink(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : deliveriesPerMinute(resource) {
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		size_t minute = static_cast<size_t>(currentTime) / 60;
+		if (minute >= deliveriesPerMinute.size()) {
+			deliveriesPerMinute.resize(minute + 1, 0);
+		}
+		deliveriesPerMinute[minute] += static_cast<size_t>(passenger.getGroupSize());
+	}
+
+	/**
+	 * @brief Gets the delivery rate in the busiest window of whole minutes.
+	 *
+	 * With the default window of 5 minutes this is the handling capacity used to size lifts, per hour.
+	 *
+	 * @param windowMinutes The length of the window in minutes.
+	 * @return The passengers delivered per hour in the busiest window, 0 if nobody was delivered.
+	 */
+	double getPeakThroughput(size_t windowMinutes = 5) const {
+		size_t windowSum = 0;
+		size_t peak = 0;
+		for (size_t minute = 0; minute < deliveriesPerMinute.size(); ++minute) {
+			windowSum += deliveriesPerMinute[minute];
+			if (minute >= windowMinutes) {
+				windowSum -= deliveriesPerMinute[minute - windowMinutes];
+			}
+			peak = std::max(peak, windowSum);
+		}
+		return 60.0 * peak / windowMinutes;
+	}
+
+private:
+	std::pmr::vector<size_t> deliveriesPerMinute; // The number of deliveries in each minute of the simulation.
+};
+
+/**
+ * @brief Writes the wait and travel time of every delivered passenger to a logger.
+ */
+class TimeLogSink : public DeliverySink {
+public:
+	/**
+	 * @brief Constructs a TimeLogSink.
+	 *
+	 * @param timeLogger The logger receiving one line per delivered passenger.
+	 */
+	explicit TimeLogSink(std::shared_ptr<spdlog::logger> timeLogger) : timeLogger(std::move(timeLogger)) {
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		if (passenger.getGroupSize() == 1) {
+			timeLogger->info("Passenger {}: wait time {}, travel time {}", passenger.getPassengerID(), passenger.getWaitTime(), passenger.getTravelTime());
+		}
+		else {
+			timeLogger->info("Passenger {} (group of {}): wait time {}, travel time {}", passenger.getPassengerID(), passenger.getGroupSize(),
+				passenger.getWaitTime(), passenger.getTravelTime());
+		}
+	}
+
+private:
+	std::shared_ptr<spdlog::logger> timeLogger; // The logger receiving delivered passengers.
+};
+
+/**
+ * @brief Appends every delivered passenger to a binary trace file.
+ *
+ * Each record is the packed 16-byte Passenger followed by the 4-byte delivery time.
+ */
+class BinaryTraceSink : public DeliverySink {
+public:
+	/**
+	 * @brief Constructs a BinaryTraceSink.
+	 *
+	 * @param fileName The path of the trace file. An existing file is overwritten.
+	 * @throw std::runtime_error if the file cannot be opened.
+	 */
+	explicit BinaryTraceSink(const std::string& fileName) : traceFile(fileName, std::ios::binary | std::ios::trunc) {
+		if (!traceFile) {
+			throw std::runtime_error("Cannot open binary trace file " + fileName);
+		}
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		std::int32_t deliveryTime = currentTime;
+		traceFile.write(reinterpret_cast<const char*>(&passenger), sizeof(Passenger));
+		traceFile.write(reinterpret_cast<const char*>(&deliveryTime), sizeof(deliveryTime));
+	}
+
+private:
+	std::ofstream traceFile; // The trace file.
+};
+
+/**
+ * @brief Keeps every delivered passenger on its destination floor.
+ *
+ * Only used when retention is requested, since memory then grows with the number of trips.
+ */
+class RetentionSink : public DeliverySink {
+public:
+	/**
+	 * @brief Constructs a RetentionSink.
+	 *
+	 * @param floors The floors of the building.
+	 */
+	explicit RetentionSink(FloorSet& floors) : floors(floors) {
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		floors.getFloor(passenger.getEndFloor()).getDeliveredPassengers().push_back(passenger);
+	}
+
+private:
+	FloorSet& floors; // The floors of the building.
+};
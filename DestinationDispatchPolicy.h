@@ -0,0 +1,473 @@
+/**
+ * @file DestinationDispatchPolicy.h
+ * @brief Declaration and implementation of the DestinationDispatchPolicy class.
+ *
+ * The DestinationDispatchPolicy class models destination dispatch: passengers enter their destination when
+ * they arrive on a floor, and are told which car to take. Only that car boards them and stops for them.
+ * Cars move with LOOK dispatch over their riders and the passengers assigned to them.
+ *
+ * Arrivals are collected over a short rolling window and assigned as one batch. The batch is ordered by
+ * start floor, direction and destination, so passengers going to the same floor are placed one after the
+ * other and the second one sees that a car already stops there. Each passenger takes the car with the
+ * lowest cost: the car's estimated time of arrival plus the delay every new stop adds for the passenger and
+ * the riders of the car, plus its energy for the passenger's call when an energy weight is set. Only cars
+ * serving both the start floor and the destination are considered. A car that fills up before everyone
+ * assigned to it has boarded hands the passengers it left behind to another car. A group enters one
+ * destination; the waits in its cost count every member, and a group larger than the room left in the
+ * best car, after its load and the passengers already assigned to it, is split across cars at assignment.
+ */
+
+#pragma once
+#include "DispatchPolicy.h"
+#include "ArrivalTimeEstimate.h"
+#include "ElevatorBank.h"
+#include "FloorSet.h"
+#include "Passenger.h"
+#include "ElevatorState.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+#include <cstdint>
+
+class DestinationDispatchPolicy : public LookDispatch<DestinationDispatchPolicy> {
+public:
+	/**
+	 * @brief Constructs a DestinationDispatchPolicy.
+	 *
+	 * @param batchWindow The time in seconds arrivals are collected before they are assigned, 0 to assign every second.
+	 * @throw std::invalid_argument if batchWindow is negative.
+	 */
+	explicit DestinationDispatchPolicy(int batchWindow = 3) : batchWindow(batchWindow) {
+		if (batchWindow < 0) {
+			throw std::invalid_argument("Batch window cannot be negative");
+		}
+	}
+
+	/**
+	 * @brief Checks if passengers assigned to the car wait on a floor to go in the given direction.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return True if the car has passengers to pick up there, false otherwise.
+	 */
+	bool answersHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return !pickups.empty() && pickups[pickupIndex(car, floorNumber, direction)] != 0;
+	}
+
+	/**
+	 * @brief Adds an arriving passenger to the batch, opening a new window if the batch was empty.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param passenger The arriving passenger.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void onPassengerArrival(const ElevatorBank& bank, const FloorSet& floors, const Passenger& passenger, int currentTime) {
+		if (batch.empty()) {
+			batchDeadline = currentTime + batchWindow;
+		}
+		batch.push_back(Request{ passenger.getPassengerID(), passenger.getStartFloor(), passenger.getEndFloor(), NO_CAR, passenger.getGroupSize() });
+	}
+
+	/**
+	 * @brief Assigns the batch once its window has closed and a car is in service.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void onTick(const ElevatorBank& bank, const FloorSet& floors, int currentTime) {
+		if (!batch.empty() && currentTime >= batchDeadline && bank.getNumOfActiveCars() > 0) {
+			assignBatch(bank);
+		}
+	}
+
+	/**
+	 * @brief Gets how many members of a waiting passenger's group were assigned to the car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param passenger The waiting passenger.
+	 * @return The number of members who may board the car, 0 if the passenger was assigned to another car.
+	 */
+	int boardingShare(const ElevatorBank& bank, int car, const Passenger& passenger) {
+		size_t id = static_cast<size_t>(passenger.getPassengerID());
+		if (id >= carOf.size() || carOf[id] == NO_CAR) {
+			return 0;
+		}
+		if (carOf[id] != SHARED) {
+			return carOf[id] == car ? passenger.getGroupSize() : 0;
+		}
+
+		int share = 0;
+		for (const Request& request : assigned) {
+			if (request.passengerID == passenger.getPassengerID() && request.car == car) {
+				share += request.members;
+			}
+		}
+		return share;
+	}
+
+	/**
+	 * @brief Removes a boarding passenger from the car's pending pickups and destinations, once the car's share of the group has boarded.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param passenger The boarding passenger.
+	 */
+	void onBoarded(const ElevatorBank& bank, int car, const Passenger& passenger) {
+		int boarded = passenger.getGroupSize();
+		for (size_t i = 0; i < assigned.size() && boarded > 0;) {
+			Request& request = assigned[i];
+			if (request.passengerID != passenger.getPassengerID() || request.car != car) {
+				++i;
+				continue;
+			}
+
+			const int members = std::min(boarded, request.members);
+			request.members -= members;
+			pendingMembers[car] -= members;
+			boarded -= members;
+			if (request.members > 0) {
+				++i;
+			}
+			else {
+				unassign(i);
+			}
+		}
+	}
+
+	/**
+	 * @brief Forgets a passenger who gave up, whether they were still in the batch or assigned to a car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building, without the passenger.
+	 * @param passenger The passenger who left.
+	 */
+	void onAbandon(const ElevatorBank& bank, const FloorSet& floors, const Passenger& passenger) {
+		for (size_t i = 0; i < batch.size(); ++i) {
+			if (batch[i].passengerID == passenger.getPassengerID()) {
+				batch.erase(batch.begin() + i);
+				return;
+			}
+		}
+
+		// every share of the group leaves with it
+		for (size_t i = 0; i < assigned.size();) {
+			if (assigned[i].passengerID == passenger.getPassengerID()) {
+				unassign(i);
+			}
+			else {
+				++i;
+			}
+		}
+	}
+
+	/**
+	 * @brief Hands the passengers a car had to leave behind, because it filled up, to the best other car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void afterBoarding(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		handOver(bank, car);
+	}
+
+	/**
+	 * @brief Hands the passengers a full car is passing by to the best other car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void onFullLoadBypass(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		handOver(bank, car);
+	}
+
+	/**
+	 * @brief Gets the number of passenger to car assignments made, including reassignments.
+	 *
+	 * @return The number of assignments.
+	 */
+	size_t getAssignmentCount() const {
+		return assignmentCount;
+	}
+
+	/**
+	 * @brief Gets the number of batches assigned.
+	 *
+	 * @return The number of batches.
+	 */
+	size_t getBatchCount() const {
+		return batchCount;
+	}
+
+private:
+	static constexpr int NO_CAR = -1; // Marks an unassigned passenger.
+	static constexpr int SHARED = -2; // Marks a group split across cars.
+
+	// A passenger waiting for a car, or the share of a group assigned to one car.
+	struct Request {
+		int passengerID; // The passenger's ID.
+		int startFloor; // The floor the passenger waits on.
+		int endFloor; // The passenger's destination.
+		int car; // The car the passenger was told to take, or NO_CAR.
+		int members; // The members of the passenger's group, or of this share of it, not aboard yet.
+
+		ElevatorDirection direction() const {
+			return startFloor < endFloor ? ElevatorDirection::UP : ElevatorDirection::DOWN;
+		}
+	};
+
+	int batchWindow; // Time in seconds arrivals are collected before they are assigned.
+	int batchDeadline = 0; // Time at which the current batch is assigned.
+	std::vector<Request> batch; // Arrivals not assigned yet.
+	std::vector<Request> assigned; // Assigned passengers and group shares that have not boarded yet.
+	std::vector<Request> handedOver; // Scratch list of the requests a car hands over.
+	std::vector<int> carOf; // Car assigned to each passenger ID, NO_CAR, or SHARED for a group split across cars.
+	std::vector<int> pickups; // Assigned passengers per car, floor and direction.
+	std::vector<int> drops; // Assigned passengers per car and destination floor.
+	std::vector<int> pendingStops; // Distinct pickup and destination stops of the assigned passengers per car.
+	std::vector<int> pendingMembers; // Assigned people per car who have not boarded yet.
+	std::vector<int> cost; // Scratch cost of each car.
+	std::vector<double> energy; // Scratch estimated energy of each car answering the call.
+	std::vector<std::uint8_t> filled; // Scratch flag of each car given a share of the group being assigned.
+	int floorCount = 0; // Number of floor entries per car in the tables, floor 0 unused.
+	size_t assignmentCount = 0; // Number of assignments made.
+	size_t batchCount = 0; // Number of batches assigned.
+
+	/**
+	 * @brief Sizes the tables for the bank and the building on first use.
+	 *
+	 * @param bank The elevators of the building.
+	 */
+	void reserve(const ElevatorBank& bank) {
+		if (pickups.empty()) {
+			floorCount = bank.getNumOfFloors() + 1;
+			pickups.assign(static_cast<size_t>(bank.size()) * 2 * floorCount, 0);
+			drops.assign(static_cast<size_t>(bank.size()) * floorCount, 0);
+			pendingStops.assign(bank.size(), 0);
+			pendingMembers.assign(bank.size(), 0);
+			cost.assign(bank.size(), 0);
+			energy.assign(bank.size(), 0.0);
+			filled.assign(bank.size(), 0);
+		}
+	}
+
+	size_t pickupIndex(int car, int floorNumber, ElevatorDirection direction) const {
+		return (static_cast<size_t>(car) * 2 + (direction == ElevatorDirection::UP ? 0 : 1)) * floorCount + floorNumber;
+	}
+
+	size_t dropIndex(int car, int floorNumber) const {
+		return static_cast<size_t>(car) * floorCount + floorNumber;
+	}
+
+	/**
+	 * @brief Assigns every passenger of the batch, grouped by start floor, direction and destination.
+	 *
+	 * @param bank The elevators of the building.
+	 */
+	void assignBatch(const ElevatorBank& bank) {
+		reserve(bank);
+		std::stable_sort(batch.begin(), batch.end(), [](const Request& a, const Request& b) {
+			if (a.startFloor != b.startFloor) {
+				return a.startFloor < b.startFloor;
+			}
+			if (a.direction() != b.direction()) {
+				return a.direction() == ElevatorDirection::UP;
+			}
+			return a.endFloor < b.endFloor;
+			});
+
+		for (const Request& request : batch) {
+			assign(bank, request, NO_CAR);
+		}
+		batch.clear();
+		++batchCount;
+	}
+
+	/**
+	 * @brief Assigns a passenger to the active car with the lowest cost among the cars that can carry them, and records it.
+	 *
+	 * The waits in the cost count every member of a group. A group larger than the room left in the chosen car
+	 * gives the car as many members as fit, and the rest go to the next best car with room. Once no other car
+	 * has room, the rest go to the cheapest car, which leaves them to another car if it fills up. If none of
+	 * the cars that can carry the passenger is in service yet, the passenger goes to the first of them, which
+	 * picks them up once it starts.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param request The passenger.
+	 * @param excludedCar A car that must not get the passenger unless it is the only candidate, or NO_CAR.
+	 */
+	void assign(const ElevatorBank& bank, Request request, int excludedCar) {
+		ElevatorDirection direction = request.direction();
+		estimateArrivalTimes(bank, request.startFloor, direction, pendingStops.data(), cost.data());
+		if (energyWeight > 0) {
+			estimateCallEnergies(bank, request.startFloor, pendingStops.data(), energy.data());
+		}
+
+		std::fill(filled.begin(), filled.end(), 0);
+		while (request.members > 0) {
+			int bestCar = NO_CAR;
+			int cheapestCar = excludedCar;
+			int bestCost = std::numeric_limits<int>::max();
+			int cheapestCost = std::numeric_limits<int>::max();
+			for (int car = 0; car < bank.getNumOfActiveCars(); ++car) {
+				if (!bank.canCarry(car, request.startFloor, request.endFloor) || car == excludedCar) {
+					continue;
+				}
+
+				// a new stop delays the passengers and everyone riding the car
+				int newStops = (pickups[pickupIndex(car, request.startFloor, direction)] == 0)
+					+ (drops[dropIndex(car, request.endFloor)] == 0 && !bank.getRiders(car).hasRidersFor(request.endFloor));
+				int total = request.members * cost[car] + newStops * bank.getStopTime(car) * (request.members + bank.getLoads()[car]);
+				if (energyWeight > 0) {
+					total += static_cast<int>(std::lround(energyWeight * energy[car]));
+				}
+
+				if (total < cheapestCost) {
+					cheapestCar = car;
+					cheapestCost = total;
+				}
+				if (!filled[car] && freeSpace(bank, car) > 0 && total < bestCost) {
+					bestCar = car;
+					bestCost = total;
+				}
+			}
+
+			Request share = request;
+			if (bestCar != NO_CAR) {
+				share.car = bestCar;
+				share.members = std::min(request.members, freeSpace(bank, bestCar));
+				filled[bestCar] = 1;
+			}
+			else if (cheapestCar != NO_CAR) {
+				share.car = cheapestCar;
+			}
+			else {
+				// none of the candidates is in service yet: wait for the first of them
+				share.car = 0;
+				while (!bank.canCarry(share.car, request.startFloor, request.endFloor)) {
+					++share.car;
+				}
+			}
+			request.members -= share.members;
+			record(share);
+		}
+		++assignmentCount;
+	}
+
+	/**
+	 * @brief Gets the room left in a car for the passengers it may still be assigned.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @return The capacity less the load and the assigned passengers who have not boarded, at least 0.
+	 */
+	int freeSpace(const ElevatorBank& bank, int car) const {
+		return std::max(0, bank.getCapacity(car) - bank.getLoads()[car] - pendingMembers[car]);
+	}
+
+	/**
+	 * @brief Adds an assigned passenger or group share to its car, merging it with a share of the group the car already has.
+	 *
+	 * @param request The assigned passenger, with its car.
+	 */
+	void record(const Request& request) {
+		if (static_cast<size_t>(request.passengerID) >= carOf.size()) {
+			carOf.resize(static_cast<size_t>(request.passengerID) + 1, NO_CAR);
+		}
+		int& car = carOf[request.passengerID];
+		if (car != NO_CAR) {
+			for (Request& other : assigned) {
+				if (other.passengerID == request.passengerID && other.car == request.car) {
+					other.members += request.members;
+					pendingMembers[request.car] += request.members;
+					return;
+				}
+			}
+		}
+
+		addStops(request, 1);
+		car = car == NO_CAR || car == request.car ? request.car : SHARED;
+		assigned.push_back(request);
+	}
+
+	/**
+	 * @brief Removes an assigned passenger or group share, with its pickup and destination, from its car.
+	 *
+	 * @param index The index of the request in the assigned list. The last request takes its place.
+	 * @return The removed request.
+	 */
+	Request unassign(size_t index) {
+		Request request = assigned[index];
+		assigned[index] = assigned.back();
+		assigned.pop_back();
+		addStops(request, -1);
+
+		// a group split across cars keeps the cars of its other shares
+		int& car = carOf[request.passengerID];
+		if (car == SHARED) {
+			car = NO_CAR;
+			for (const Request& other : assigned) {
+				if (other.passengerID == request.passengerID) {
+					car = car == NO_CAR || car == other.car ? other.car : SHARED;
+				}
+			}
+		}
+		else {
+			car = NO_CAR;
+		}
+		return request;
+	}
+
+	/**
+	 * @brief Adds or removes a passenger's pickup and destination in the tables of its car.
+	 *
+	 * @param request The assigned passenger.
+	 * @param delta 1 to add the passenger, -1 to remove it.
+	 */
+	void addStops(const Request& request, int delta) {
+		int& pickup = pickups[pickupIndex(request.car, request.startFloor, request.direction())];
+		int& drop = drops[dropIndex(request.car, request.endFloor)];
+		pendingStops[request.car] -= (pickup != 0) + (drop != 0);
+		pickup += delta;
+		drop += delta;
+		pendingStops[request.car] += (pickup != 0) + (drop != 0);
+		pendingMembers[request.car] += delta * request.members;
+	}
+
+	/**
+	 * @brief Reassigns the passengers waiting for a car at its floor, in its direction, to the best other car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 */
+	void handOver(const ElevatorBank& bank, int car) {
+		int floorNumber = bank.getCurrentFloor(car);
+		ElevatorDirection direction = bank.getDirection(car);
+		if (pickups.empty() || pickups[pickupIndex(car, floorNumber, direction)] == 0) {
+			return;
+		}
+
+		handedOver.clear();
+		for (size_t i = 0; i < assigned.size();) {
+			const Request& request = assigned[i];
+			if (request.car == car && request.startFloor == floorNumber && request.direction() == direction) {
+				handedOver.push_back(unassign(i));
+			}
+			else {
+				++i;
+			}
+		}
+		for (const Request& request : handedOver) {
+			assign(bank, request, car);
+		}
+	}
+};
@@ -0,0 +1,567 @@
+/**
+ * @file DispatchPolicy.h
+ * @brief Declaration and implementation of the dispatch policies.
+ *
+ * A dispatch policy decides where each car goes and where it stops. The ElevatorBank update kernel is
+ * templated on the policy, so every decision is an ordinary inlined call rather than a virtual one.
+ *
+ * A policy provides three methods, each given the bank, the index of the car and the floors:
+ * - boardingDirection: the direction a stopped car boards passengers in.
+ * - nextMove: MOVING_UP or MOVING_DOWN to travel one more floor, or STOPPED to stay at the current floor.
+ *   It is called after a stopped car has boarded, and when a moving car passes a floor without stopping.
+ * - shouldStop: whether a moving car stops at the floor it has just reached.
+ *
+ * Policies derive from DispatchPolicy, which supplies the usual collective-control stop rule and no-op
+ * versions of the optional hooks:
+ * - answersHallCall: whether a car may stop for a hall call, used to split calls between cars. It is only
+ *   asked about calls the car can carry someone for, see FloorSet::canAnswer.
+ * - onHallCall: called by Building when a passenger creates a new hall call.
+ * - onPassengerArrival: called by Building for every passenger joining a floor's waiting queue.
+ * - onTick: called by Building once per second, before the cars are updated.
+ * - onTrafficModeChange: called by Building when traffic detection sees a new regime (see TrafficMode.h).
+ * - onAbandon: called by Building when a waiting passenger runs out of patience and leaves (see Patience.h).
+ * - boardingShare: how many members of a waiting record may board a car, used to tie passengers to cars.
+ * - onBoarded: called for every passenger boarding a car.
+ * - afterBoarding: called when a stopped car has finished boarding at a floor with waiting passengers.
+ * - onFullLoadBypass: called when a full car passes a hall call it answers, so the call can go to another car.
+ * - flightWaypoint: a floor a car is heading for without a call or rider there, so event-driven travel does not fly past it.
+ *
+ * A full car does not stop for hall calls, since nobody could board it. This load-weighing bypass can be
+ * switched off with setFullLoadBypass, to measure the stops it saves.
+ *
+ * Policies that assign calls to single cars by cost can add the energy a car would spend answering the
+ * call to its time, at the exchange rate set with setEnergyWeight (see EnergyModel.h).
+ */
+
+#pragma once
+#include "Passenger.h"
+#include "ElevatorBank.h"
+#include "FloorSet.h"
+#include "CarSchedule.h"
+#include "TrafficMode.h"
+#include "ElevatorState.h"
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Base class of the dispatch policies, using the curiously recurring template pattern.
+ *
+ * @tparam Derived The policy deriving from this class.
+ */
+template <typename Derived>
+class DispatchPolicy {
+public:
+	/**
+	 * @brief Checks if a car should stop at the floor it has just reached.
+	 *
+	 * The car stops if a rider gets off here, or if someone here is waiting to go the car's way and the
+	 * car has room for them. A double-deck car also stops for a call at the floor of its upper deck.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return True if the elevator should stop at the floor, false otherwise.
+	 */
+	bool shouldStop(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		int floorNumber = bank.getCurrentFloor(car);
+
+		// check if there are passengers in the elevator that want to get off at this floor
+		if (bank.getRiders(car).hasRidersFor(floorNumber)) {
+			return true;
+		}
+
+		// check if there are passengers at a deck that want to go in the same direction, and if that deck has room
+		ElevatorDirection direction = bank.getDirection(car);
+		bool called = false;
+		bool room = false;
+		for (int deckFloor = floorNumber; deckFloor <= bank.getUpperDeckFloor(car); ++deckFloor) {
+			if (floors.hasHallCall(deckFloor, direction) && floors.canAnswer(deckFloor, direction, car)
+				&& derived().answersHallCall(bank, car, floors, deckFloor, direction)) {
+				called = true;
+				room |= !bank.isDeckFull(car, deckFloor - floorNumber);
+			}
+		}
+		if (!called) {
+			return false;
+		}
+
+		// if every called deck is at capacity, nobody can board, so pass the call by and let another car serve it
+		if (!room) {
+			++fullLoadCallCount;
+			if (fullLoadBypass) {
+				derived().onFullLoadBypass(bank, car, floors);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Sets whether full cars pass hall calls by. The bypass is on by default.
+	 *
+	 * @param enabled True to pass calls by when full, false to stop for them anyway.
+	 */
+	void setFullLoadBypass(bool enabled) {
+		fullLoadBypass = enabled;
+	}
+
+	/**
+	 * @brief Gets the number of times a full car reached a hall call it answers.
+	 *
+	 * With the bypass on each of these was a stop saved, with it off a stop where nobody could board.
+	 *
+	 * @return The number of hall calls reached by a full car.
+	 */
+	size_t getFullLoadCallCount() const {
+		return fullLoadCallCount;
+	}
+
+	/**
+	 * @brief Sets how many seconds of time a kWh of energy is worth in the assignment cost. Cost is time only by default.
+	 *
+	 * @param secondsPerKWh The weight of energy against time, 0 to ignore energy.
+	 * @throw std::invalid_argument if the weight is negative.
+	 */
+	void setEnergyWeight(double secondsPerKWh) {
+		if (secondsPerKWh < 0) {
+			throw std::invalid_argument("The energy weight cannot be negative");
+		}
+		energyWeight = secondsPerKWh;
+	}
+
+	/**
+	 * @brief Gets how many seconds of time a kWh of energy is worth in the assignment cost.
+	 *
+	 * @return The weight of energy against time.
+	 */
+	double getEnergyWeight() const {
+		return energyWeight;
+	}
+
+	/**
+	 * @brief Checks if a car may answer a hall call. Every car answers every call by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return True if the car may stop for the call, false otherwise.
+	 */
+	bool answersHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return true;
+	}
+
+	/**
+	 * @brief Called when a passenger arrives at a floor where nobody was waiting to go their way. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the new hall call.
+	 * @param direction The direction of the new hall call.
+	 */
+	void onHallCall(const ElevatorBank& bank, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+	}
+
+	/**
+	 * @brief Called when a passenger joins the waiting queue of their start floor. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param passenger The arriving passenger.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void onPassengerArrival(const ElevatorBank& bank, const FloorSet& floors, const Passenger& passenger, int currentTime) {
+	}
+
+	/**
+	 * @brief Called once per second before the cars are updated. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void onTick(const ElevatorBank& bank, const FloorSet& floors, int currentTime) {
+	}
+
+	/**
+	 * @brief Called when the traffic mode of the building changes, so the policy can switch strategy. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param mode The new traffic mode.
+	 */
+	void onTrafficModeChange(const ElevatorBank& bank, const FloorSet& floors, TrafficMode mode) {
+	}
+
+	/**
+	 * @brief Called when a waiting passenger has given up and left their floor. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building, without the passenger.
+	 * @param passenger The passenger who left.
+	 */
+	void onAbandon(const ElevatorBank& bank, const FloorSet& floors, const Passenger& passenger) {
+	}
+
+	/**
+	 * @brief Gets how many members of a waiting record may board a car. Anyone going the car's way may board by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param passenger The waiting passenger or group.
+	 * @return The number of members who may board the car, 0 to keep the record waiting.
+	 */
+	int boardingShare(const ElevatorBank& bank, int car, const Passenger& passenger) {
+		return passenger.getGroupSize();
+	}
+
+	/**
+	 * @brief Called when a passenger boards a car. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param passenger The boarding passenger.
+	 */
+	void onBoarded(const ElevatorBank& bank, int car, const Passenger& passenger) {
+	}
+
+	/**
+	 * @brief Called when a stopped car has boarded passengers at its floor. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void afterBoarding(const ElevatorBank& bank, int car, const FloorSet& floors) {
+	}
+
+	/**
+	 * @brief Called when a full car passes a hall call it answers at its current floor, in its direction. Does nothing by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void onFullLoadBypass(const ElevatorBank& bank, int car, const FloorSet& floors) {
+	}
+
+	/**
+	 * @brief Gets a floor a car is heading for although nobody waits or gets off there. None by default.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @return The floor, or 0 for none.
+	 */
+	int flightWaypoint(const ElevatorBank& bank, int car) {
+		return 0;
+	}
+
+protected:
+	bool fullLoadBypass = true; // Whether full cars pass hall calls by.
+	size_t fullLoadCallCount = 0; // Number of hall calls reached by a full car.
+	double energyWeight = 0.0; // Seconds of time a kWh of energy is worth in the assignment cost.
+
+	/**
+	 * @brief Checks if a car has no room for another passenger on any deck.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @return True if the car is full, false otherwise.
+	 */
+	static bool isFull(const ElevatorBank& bank, int car) {
+		return bank.getLoads()[car] >= bank.getCapacity(car);
+	}
+
+	/**
+	 * @brief Gets the policy deriving from this class.
+	 *
+	 * @return A reference to the derived policy.
+	 */
+	Derived& derived() {
+		return static_cast<Derived&>(*this);
+	}
+};
+
+/**
+ * @brief The reference policy: every car sweeps from floor 1 to the top floor and back, whatever the demand.
+ */
+class FullSweepPolicy : public DispatchPolicy<FullSweepPolicy> {
+public:
+	/**
+	 * @brief Chooses the direction a stopped car boards in.
+	 *
+	 * If we are at the top or bottom floor, change direction so we can pick the right passengers.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return The boarding direction.
+	 */
+	ElevatorDirection boardingDirection(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		if (bank.getCurrentFloor(car) == 1) {
+			return ElevatorDirection::UP;
+		}
+		else if (bank.getCurrentFloor(car) == bank.getNumOfFloors()) {
+			return ElevatorDirection::DOWN;
+		}
+		return bank.getDirection(car);
+	}
+
+	/**
+	 * @brief Chooses the next move of a car.
+	 *
+	 * Keep moving in the same direction until we reach the top or bottom floor, then turn around.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return MOVING_UP or MOVING_DOWN.
+	 */
+	ElevatorState nextMove(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		if (ElevatorDirection::UP == bank.getDirection(car)) {
+			return bank.getCurrentFloor(car) != bank.getNumOfFloors() ? ElevatorState::MOVING_UP : ElevatorState::MOVING_DOWN;
+		}
+		return bank.getCurrentFloor(car) != 1 ? ElevatorState::MOVING_DOWN : ElevatorState::MOVING_UP;
+	}
+};
+
+/**
+ * @brief LOOK dispatch: a car only travels as far as its furthest rider or hall call, then reverses or idles.
+ *
+ * A car keeps its direction while there is a rider destination or a hall call it answers ahead of it. Once
+ * nothing is ahead it turns around if there is work behind it, and otherwise returns to its parking floor,
+ * or stays stopped where it is if it has none, until a call comes in. Which hall calls a car answers is left to the derived policy.
+ *
+ * @tparam Derived The policy deriving from this class.
+ */
+template <typename Derived>
+class LookDispatch : public DispatchPolicy<Derived> {
+public:
+	/**
+	 * @brief Chooses the direction a stopped car boards in.
+	 *
+	 * Keep the current direction while there is work ahead or someone here the car can carry wants to go that way,
+	 * otherwise turn around for the passengers here or the work behind the car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return The boarding direction.
+	 */
+	ElevatorDirection boardingDirection(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		ElevatorDirection direction = bank.getDirection(car);
+		ElevatorDirection reverse = opposite(direction);
+
+		if (hasWorkAhead(bank, car, floors, direction) || hasCallAtDecks(bank, car, floors, direction)) {
+			return direction;
+		}
+		if (hasCallAtDecks(bank, car, floors, reverse) || hasWorkAhead(bank, car, floors, reverse)) {
+			return reverse;
+		}
+		return direction;
+	}
+
+	/**
+	 * @brief Chooses the next move of a car.
+	 *
+	 * Move on while there is work ahead, turn around if there is only work behind, otherwise head for the
+	 * car's parking floor or stay.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return MOVING_UP, MOVING_DOWN, or STOPPED when there is nothing to do and the car is parked.
+	 */
+	ElevatorState nextMove(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		ElevatorDirection direction = bank.getDirection(car);
+		if (hasWorkAhead(bank, car, floors, direction)) {
+			return moveTowards(direction);
+		}
+		if (hasWorkAhead(bank, car, floors, opposite(direction))) {
+			return moveTowards(opposite(direction));
+		}
+
+		// with nothing to do, return to the parking floor if the car has one
+		int parking = bank.getParkingFloor(car);
+		if (parking != CarSchedule::NO_PARKING && parking != bank.getCurrentFloor(car)) {
+			return moveTowards(parking > bank.getCurrentFloor(car) ? ElevatorDirection::UP : ElevatorDirection::DOWN);
+		}
+		return ElevatorState::STOPPED;
+	}
+
+	/**
+	 * @brief Checks if a car should stop at the floor it has just reached.
+	 *
+	 * On top of the collective-control rule, a car with nothing ahead stops for a call it answers here,
+	 * whichever way the call is going, since this is where it turns around, unless it is full.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return True if the elevator should stop at the floor, false otherwise.
+	 */
+	bool shouldStop(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		if (DispatchPolicy<Derived>::shouldStop(bank, car, floors)) {
+			return true;
+		}
+		if (this->fullLoadBypass && this->isFull(bank, car)) {
+			return false;
+		}
+		if (hasWorkAhead(bank, car, floors, bank.getDirection(car))) {
+			return false;
+		}
+		for (int deckFloor = bank.getCurrentFloor(car); deckFloor <= bank.getUpperDeckFloor(car); ++deckFloor) {
+			const bool deckFull = bank.isDeckFull(car, deckFloor - bank.getCurrentFloor(car));
+			if (!(this->fullLoadBypass && deckFull) && answersAnyHallCall(bank, car, floors, deckFloor)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+protected:
+	/**
+	 * @brief Checks if a car has a rider destination or a hall call it answers beyond its floor in the given direction.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param direction The direction to look in.
+	 * @return True if there is work that way, false otherwise.
+	 */
+	bool hasWorkAhead(const ElevatorBank& bank, int car, const FloorSet& floors, ElevatorDirection direction) {
+		int floorNumber = bank.getCurrentFloor(car);
+		if (direction == ElevatorDirection::UP) {
+			if (bank.getRiders(car).hasRidersAbove(floorNumber)) {
+				return true;
+			}
+			for (int call = floors.findHallCallAbove(floorNumber); call != 0; call = floors.findHallCallAbove(call)) {
+				if (answersAnyHallCall(bank, car, floors, call)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		if (bank.getRiders(car).hasRidersBelow(floorNumber)) {
+			return true;
+		}
+		for (int call = floors.findHallCallBelow(floorNumber); call != 0; call = floors.findHallCallBelow(call)) {
+			if (answersAnyHallCall(bank, car, floors, call)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Checks if a car answers a hall call in either direction at a floor.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor to check.
+	 * @return True if there is a call at the floor the car answers, false otherwise.
+	 */
+	bool answersAnyHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber) {
+		return answersWaitingCall(bank, car, floors, floorNumber, ElevatorDirection::UP) || answersWaitingCall(bank, car, floors, floorNumber, ElevatorDirection::DOWN);
+	}
+
+	/**
+	 * @brief Checks if there is a hall call at a floor that a car can carry someone for and answers.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor to check.
+	 * @param direction The direction of the call.
+	 * @return True if the car answers the call, false otherwise.
+	 */
+	bool answersWaitingCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return hasCallFor(car, floors, floorNumber, direction) && this->derived().answersHallCall(bank, car, floors, floorNumber, direction);
+	}
+
+	/**
+	 * @brief Checks if no other active candidate car is closer to a floor, breaking ties by car index.
+	 *
+	 * With the full-load bypass on, full cars are left out, since they would pass the floor by.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floorNumber The floor.
+	 * @param candidates The set of the cars to compare with, e.g. FloorSet::getHallCallCars.
+	 * @return True if the car is the nearest to the floor, false otherwise.
+	 */
+	bool isNearestActiveCar(const ElevatorBank& bank, int car, int floorNumber, CarMask candidates) const {
+		int distance = std::abs(bank.getCurrentFloor(car) - floorNumber);
+		for (int other = 0; other < bank.getNumOfActiveCars(); ++other) {
+			int otherDistance = std::abs(bank.getCurrentFloor(other) - floorNumber);
+			bool skipped = !candidates.contains(other) || (this->fullLoadBypass && this->isFull(bank, other));
+			if (other != car && !skipped && (otherDistance < distance || (otherDistance == distance && other < car))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Checks if someone waiting at a floor to go in the given direction can ride a car.
+	 *
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor to check.
+	 * @param direction The direction of the call.
+	 * @return True if there is a hall call the car can carry someone for, false otherwise.
+	 */
+	static bool hasCallFor(int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return floors.hasHallCall(floorNumber, direction) && floors.canAnswer(floorNumber, direction, car);
+	}
+
+	/**
+	 * @brief Checks if there is a hall call a car can carry someone for at the floor of any of its decks.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param direction The direction of the call.
+	 * @return True if there is such a call, false otherwise.
+	 */
+	static bool hasCallAtDecks(const ElevatorBank& bank, int car, const FloorSet& floors, ElevatorDirection direction) {
+		for (int deckFloor = bank.getCurrentFloor(car); deckFloor <= bank.getUpperDeckFloor(car); ++deckFloor) {
+			if (hasCallFor(car, floors, deckFloor, direction)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static ElevatorDirection opposite(ElevatorDirection direction) {
+		return direction == ElevatorDirection::UP ? ElevatorDirection::DOWN : ElevatorDirection::UP;
+	}
+
+	static ElevatorState moveTowards(ElevatorDirection direction) {
+		return direction == ElevatorDirection::UP ? ElevatorState::MOVING_UP : ElevatorState::MOVING_DOWN;
+	}
+};
+
+/**
+ * @brief LOOK policy where a hall call draws only the active car nearest to it, so idle cars do not all chase it.
+ */
+class LookPolicy : public LookDispatch<LookPolicy> {
+public:
+	/**
+	 * @brief Checks if no other active car that can carry the waiting passengers is closer to a hall call, breaking ties by car index.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return True if the car is the nearest to the call, false otherwise.
+	 */
+	bool answersHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return isNearestActiveCar(bank, car, floorNumber, floors.getHallCallCars(floorNumber, direction));
+	}
+};
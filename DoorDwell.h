@@ -0,0 +1,155 @@
+/**
+ * @file DoorDwell.h
+ * @brief Declaration and implementation of the door dwell model and the stop events.
+ *
+ * A DwellModel computes how long a car stands at a floor from its door timings and the number of
+ * passengers getting off and on, instead of the fixed ELEVATOR_STOP_TIME. With door reopening on,
+ * passengers arriving while the doors close still board, at the cost of another open and close.
+ *
+ * Every stop a car makes is reported to the StopSinks of the bank as a StopEvent once the doors have
+ * closed, with its time split into door movement and passenger transfer, so travel and door time can be
+ * told apart downstream. StopTimeSink adds them up.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <cstddef>
+
+/**
+ * @brief Door timings and per-passenger transfer times, in seconds.
+ */
+struct DwellModel {
+	double doorOpenTime = 2.0; // Time for the doors to open.
+	double doorCloseTime = 3.0; // Time for the doors to close.
+	double boardingTime = 1.2; // Time for one passenger to get on.
+	double alightingTime = 1.0; // Time for one passenger to get off.
+	bool reopen = true; // Whether passengers arriving while the doors close make them reopen.
+
+	/**
+	 * @brief Checks the timings.
+	 *
+	 * @throw std::invalid_argument if a time is negative.
+	 */
+	void validate() const {
+		if (doorOpenTime < 0 || doorCloseTime < 0 || boardingTime < 0 || alightingTime < 0) {
+			throw std::invalid_argument("Door and transfer times cannot be negative");
+		}
+	}
+
+	/**
+	 * @brief Gets the time a car stands at a floor between arriving and serving its first passenger.
+	 *
+	 * A stop spans at least the tick of arrival and the tick the car acts in, hence the minimum of 2 seconds.
+	 *
+	 * @return The time in whole seconds.
+	 */
+	int openingTicks() const {
+		return std::max(2, static_cast<int>(std::lround(doorOpenTime)));
+	}
+
+	/**
+	 * @brief Gets the time passengers take to get off and on.
+	 *
+	 * @param alighted The number of passengers getting off.
+	 * @param boarded The number of passengers getting on.
+	 * @return The time in seconds.
+	 */
+	double transferTime(int alighted, int boarded) const {
+		return alighted * alightingTime + boarded * boardingTime;
+	}
+};
+
+/**
+ * @brief One stop of a car, reported once its doors have closed.
+ */
+struct StopEvent {
+	int car = 0; // The index of the car.
+	int floorNumber = 0; // The floor of the stop.
+	int arrivalTime = 0; // The time the car arrived, in seconds.
+	int duration = 0; // The time from arrival until the car could leave, in seconds.
+	double doorTime = 0.0; // The part of the duration spent opening and closing the doors.
+	double transferTime = 0.0; // The part of the duration spent with passengers getting off and on.
+	int alighted = 0; // The number of passengers who got off.
+	int boarded = 0; // The number of passengers who got on.
+	int reopenings = 0; // The number of times the doors reopened for late arrivals.
+};
+
+class StopSink {
+public:
+	virtual ~StopSink() = default;
+
+	/**
+	 * @brief Receives a stop once the doors of the car have closed.
+	 *
+	 * @param stop The stop.
+	 */
+	virtual void record(const StopEvent& stop) = 0;
+};
+
+/**
+ * @brief Adds up the time cars spend at stops, split into door movement and passenger transfer.
+ */
+class StopTimeSink : public StopSink {
+public:
+	void record(const StopEvent& stop) override {
+		++stopCount;
+		totalDuration += stop.duration;
+		doorTime += stop.doorTime;
+		transferTime += stop.transferTime;
+		reopenings += stop.reopenings;
+	}
+
+	/**
+	 * @brief Gets the number of stops recorded.
+	 *
+	 * @return The number of stops.
+	 */
+	size_t getStopCount() const {
+		return stopCount;
+	}
+
+	/**
+	 * @brief Gets the total time cars stood at stops.
+	 *
+	 * @return The time in seconds.
+	 */
+	long long getTotalDuration() const {
+		return totalDuration;
+	}
+
+	/**
+	 * @brief Gets the total time spent opening and closing doors.
+	 *
+	 * @return The time in seconds.
+	 */
+	double getDoorTime() const {
+		return doorTime;
+	}
+
+	/**
+	 * @brief Gets the total time spent with passengers getting off and on.
+	 *
+	 * @return The time in seconds.
+	 */
+	double getTransferTime() const {
+		return transferTime;
+	}
+
+	/**
+	 * @brief Gets the number of times doors reopened for late arrivals.
+	 *
+	 * @return The number of reopenings.
+	 */
+	size_t getReopenings() const {
+		return reopenings;
+	}
+
+private:
+	size_t stopCount = 0; // The number of stops recorded.
+	long long totalDuration = 0; // The total time cars stood at stops, in seconds.
+	double doorTime = 0.0; // The total door time, in seconds.
+	double transferTime = 0.0; // The total transfer time, in seconds.
+	size_t reopenings = 0; // The number of reopenings.
+};
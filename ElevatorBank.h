@@ -0,0 +1,1011 @@
+/**
+ * @file ElevatorBank.h
+ * @brief Declaration and implementation of the ElevatorBank class.
+ *
+ * The ElevatorBank class represents all elevators in the building.
+ * It manages the movement of the elevators, including picking up and dropping off passengers,
+ * and logging relevant information.
+ *
+ * The hot state of every car (current floor, next action time, state and direction) is kept in
+ * separate cache-aligned arrays, the riders of every car in a RiderBuckets, and the cold logging
+ * data in a side table of ElevatorLog objects. The update kernel first collects the cars that are
+ * due at the current time in one branch-free pass and then advances only those cars, in car order.
+ * The decisions of where a car goes and where it stops come from a dispatch policy (see DispatchPolicy.h),
+ * passed as a template parameter so there are no virtual calls on the hot path.
+ *
+ * Travel times come from a flight-time table holding the time of a run of d floors from rest to rest. By
+ * default every floor takes ELEVATOR_SPEED seconds; setFlightTimes installs a table from a kinematic model
+ * (see CarKinematics.h). A moving car is charged the difference between the table entries of its run so far
+ * and of its run one floor longer, so a run ending in a stop takes exactly its table time. In the default
+ * per-floor mode the policy decides at every floor; in event-driven mode a departing car flies straight to
+ * the next floor where anything could happen (a rider destination, a hall call, its parking floor, the
+ * policy's waypoint or the end of the shaft), and the floors in between are not simulated.
+ *
+ * A stop takes ELEVATOR_STOP_TIME seconds unless a DwellModel is set (see DoorDwell.h). Then the doors
+ * take their opening time, the car holds them for the passengers getting off and on plus the closing
+ * time, and reopens them for passengers arriving meanwhile if the model allows it. Every stop is reported
+ * to the stop sinks once the doors have closed.
+ *
+ * All cars share the speed, stopping time and capacity given to the constructor unless setCarSpec gives
+ * a car its own (see CarSpec.h). The floors each car serves are kept as a set of cars per floor (see CarMask.h),
+ * so a served-floor check is one bit test whatever the size of the bank. A car never boards a passenger
+ * unless it serves both their floors.
+ *
+ * A double-deck car stands with its lower deck at its current floor and its upper deck one floor higher,
+ * and serves both floors in one stop. Passengers board the deck level with their floor, and each deck
+ * holds the car's capacity. An upper-deck rider gets off at the stop one floor below their destination,
+ * so the riders are bucketed by stop (see RiderBuckets.h) and a stop unloads both decks in one pass. At
+ * the top floor the upper deck stands in the overhead and takes nobody; it cannot take anyone to floor 1.
+ *
+ * A group of passengers (see Passenger.h) is one record in the queues and the cars, and loads count its
+ * members. It boards as a unit if it fits in the deck; with group splitting on, the members who fit board
+ * and the rest wait for the next car. A group too large for a deck always splits.
+ *
+ * A car that has run out of work, with nobody aboard and its doors closed, goes IDLE at its parking floor,
+ * or where it is if it has none. With dynamic parking on, such a car has no parking floor: it asks for one
+ * (see ParkingPolicy.h) and gives it up again once it boards someone or leaves it for a call.
+ *
+ * Every car keeps an energy account (see EnergyModel.h). A departing car is charged its run at its current
+ * load, and its start if it was standing; a car standing empty with closed doors is charged standby power
+ * for each second it waits. The figures change only at these transitions, not per floor passed.
+ */
+
+#pragma once
+#include "Passenger.h"
+#include "ElevatorState.h"
+#include "FloorSet.h"
+#include "CarMask.h"
+#include "RiderBuckets.h"
+#include "DeliverySink.h"
+#include "ElevatorLog.h"
+#include "AlignedArray.h"
+#include "DoorDwell.h"
+#include "CarSpec.h"
+#include "EnergyModel.h"
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+class ElevatorBank {
+public:
+	/**
+	 * @brief Constructs an ElevatorBank with the specified parameters.
+	 *
+	 * @param numOfElevators The number of elevators in the bank.
+	 * @param numOfFloors The number of floors in the building.
+	 * @param speed The time it takes an elevator to move between floors, in seconds.
+	 * @param elevatorStoppingTime The time it takes for an elevator to stop at each floor.
+	 * @param logFileName The file name prefix for logging elevator activities.
+	 * @param resource The memory resource used for the per-car arrays, the per-floor tables and the riders.
+	 * @param quiet True to drop the elevator log messages instead of writing log files.
+	 */
+	ElevatorBank(int numOfElevators, int numOfFloors, int speed, int elevatorStoppingTime, const std::string& logFileName,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource(), bool quiet = false)
+		: NUM_OF_ELEVATORS(numOfElevators), NUM_OF_FLOORS(numOfFloors), ELEVATOR_SPEED(speed), ELEVATOR_STOP_TIME{ elevatorStoppingTime },
+		currentFloor(numOfElevators, 1, resource), nextActionTime(numOfElevators, 0, resource),
+		state(numOfElevators, ElevatorState::STOPPED, resource), direction(numOfElevators, ElevatorDirection::UP, resource),
+		load(numOfElevators, 0, resource), dueCars(numOfElevators, 0, resource), parkingFloor(numOfElevators, 0, resource),
+		targetFloor(numOfElevators, 1, resource), runLength(numOfElevators, 0, resource), carSpeed(numOfElevators, speed, resource),
+		carStopTime(numOfElevators, elevatorStoppingTime, resource), capacity(numOfElevators, 8, resource),
+		decks(numOfElevators, 1, resource), upperLoad(numOfElevators, 0, resource),
+		flightTimes(static_cast<size_t>(numOfElevators) * numOfFloors, 0, resource), carsServing(numOfFloors + 1, numOfElevators, true, resource),
+		doorState(numOfElevators, DOORS_CLOSED, resource), riders(resource), logs(resource), openStops(numOfElevators, resource),
+		stopSinks(resource), carEnergy(numOfElevators, resource), parkingRequests(resource) {
+		for (int car = 0; car < numOfElevators; ++car) {
+			for (int floors = 0; floors < numOfFloors; ++floors) {
+				flightTimes[static_cast<size_t>(car) * numOfFloors + floors] = floors * speed;
+			}
+		}
+		riders.reserve(numOfElevators);
+		logs.reserve(numOfElevators);
+		for (int i = 0; i < numOfElevators; ++i) {
+			riders.emplace_back(numOfFloors, resource);
+			logs.emplace_back(i, logFileName, quiet);
+		}
+	}
+
+	/**
+	 * @brief Gets the number of elevators in the bank.
+	 *
+	 * @return The number of elevators.
+	 */
+	int size() const {
+		return NUM_OF_ELEVATORS;
+	}
+
+	/**
+	 * @brief Checks if an elevator has passengers.
+	 *
+	 * @param car The index of the elevator.
+	 * @return True if the elevator has passengers, false otherwise.
+	 */
+	bool hasPassengers(int car) const {
+		return !riders[car].empty();
+	}
+
+	/**
+	 * @brief Gets the number of cars in service during the current update.
+	 *
+	 * @return The number of active cars, counted from car 0.
+	 */
+	int getNumOfActiveCars() const {
+		return activeCars;
+	}
+
+	/**
+	 * @brief Gets the number of floors in the building.
+	 *
+	 * @return The number of floors.
+	 */
+	int getNumOfFloors() const {
+		return NUM_OF_FLOORS;
+	}
+
+	/**
+	 * @brief Gets the floor where an elevator is.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The current floor, of the lower deck for a double-deck car.
+	 */
+	int getCurrentFloor(int car) const {
+		return currentFloor[car];
+	}
+
+	/**
+	 * @brief Gets the highest floor an elevator serves where it stands.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The floor of the upper deck of a double-deck car below the top floor, the current floor otherwise.
+	 */
+	int getUpperDeckFloor(int car) const {
+		return std::min(currentFloor[car] + decks[car] - 1, NUM_OF_FLOORS);
+	}
+
+	/**
+	 * @brief Gets the number of decks of an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @return 2 for a double-deck car, 1 otherwise.
+	 */
+	int getDeckCount(int car) const {
+		return decks[car];
+	}
+
+	/**
+	 * @brief Gets the direction of an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The current direction.
+	 */
+	ElevatorDirection getDirection(int car) const {
+		return direction[car];
+	}
+
+	/**
+	 * @brief Gets the state of an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The current state.
+	 */
+	ElevatorState getState(int car) const {
+		return state[car];
+	}
+
+	/**
+	 * @brief Gets the current floor of every car, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of current floors.
+	 */
+	const AlignedArray<int>& getCurrentFloors() const {
+		return currentFloor;
+	}
+
+	/**
+	 * @brief Gets the direction of every car, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of directions.
+	 */
+	const AlignedArray<ElevatorDirection>& getDirections() const {
+		return direction;
+	}
+
+	/**
+	 * @brief Gets the state of every car, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of states.
+	 */
+	const AlignedArray<ElevatorState>& getStates() const {
+		return state;
+	}
+
+	/**
+	 * @brief Gets the number of riders in every car, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of rider counts.
+	 */
+	const AlignedArray<int>& getLoads() const {
+		return load;
+	}
+
+	/**
+	 * @brief Gets the parking floor of an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The parking floor, or 0 if the car has none.
+	 */
+	int getParkingFloor(int car) const {
+		return parkingFloor[car];
+	}
+
+	/**
+	 * @brief Sets the parking floor of an elevator and moves the car there. Call it before the simulation starts.
+	 *
+	 * @param car The index of the elevator.
+	 * @param floorNumber The parking floor, or 0 to leave the car at its lowest served floor without a parking floor.
+	 * @throw std::out_of_range if the floor is not in the building or not served by the car.
+	 */
+	void setParkingFloor(int car, int floorNumber) {
+		if (floorNumber < 0 || floorNumber > NUM_OF_FLOORS || (floorNumber != 0 && !serves(car, floorNumber))) {
+			throw std::out_of_range("Parking floor " + std::to_string(floorNumber) + " is not served by car " + std::to_string(car));
+		}
+		parkingFloor[car] = floorNumber;
+		currentFloor[car] = floorNumber == 0 ? lowestServedFloor(car) : floorNumber;
+	}
+
+	/**
+	 * @brief Sends an elevator to a new parking floor during the simulation.
+	 *
+	 * @param car The index of the elevator.
+	 * @param floorNumber The parking floor, or 0 for none.
+	 * @throw std::out_of_range if the floor is not in the building or not served by the car.
+	 */
+	void assignParkingFloor(int car, int floorNumber) {
+		if (floorNumber < 0 || floorNumber > NUM_OF_FLOORS || (floorNumber != 0 && !serves(car, floorNumber))) {
+			throw std::out_of_range("Parking floor " + std::to_string(floorNumber) + " is not served by car " + std::to_string(car));
+		}
+		parkingFloor[car] = floorNumber;
+	}
+
+	/**
+	 * @brief Sets whether cars give up their parking floors when they get work and ask for new ones when they run out.
+	 *
+	 * @param enabled True for parking floors chosen during the simulation, false for fixed ones.
+	 */
+	void setDynamicParking(bool enabled) {
+		dynamicParking = enabled;
+	}
+
+	/**
+	 * @brief Gets the cars that ran out of work in the current update and need a parking floor.
+	 *
+	 * @return The indices of the cars, in car order.
+	 */
+	const std::pmr::vector<int>& getParkingRequests() const {
+		return parkingRequests;
+	}
+
+	/**
+	 * @brief Forgets the parking requests once they have been answered.
+	 */
+	void clearParkingRequests() {
+		parkingRequests.clear();
+	}
+
+	/**
+	 * @brief Gives a car its own speed, stopping time, capacity, served floors and decks. Call it before the simulation starts.
+	 *
+	 * The car's flight times become its speed times the length of the run. A car standing on a floor it does
+	 * not serve moves to its lowest served floor, and a parking floor it does not serve is dropped.
+	 *
+	 * @param car The index of the elevator.
+	 * @param spec The specification of the car.
+	 * @throw std::invalid_argument if a value of the specification is less than 1.
+	 * @throw std::out_of_range if a served floor is not in the building.
+	 */
+	void setCarSpec(int car, const CarSpec& spec) {
+		spec.validate(NUM_OF_FLOORS);
+		carSpeed[car] = spec.speed;
+		carStopTime[car] = spec.stopTime;
+		capacity[car] = spec.capacity;
+		decks[car] = spec.decks;
+		for (int floors = 0; floors < NUM_OF_FLOORS; ++floors) {
+			flightTimes[static_cast<size_t>(car) * NUM_OF_FLOORS + floors] = floors * spec.speed;
+		}
+
+		for (int floorNumber = 1; floorNumber <= NUM_OF_FLOORS; ++floorNumber) {
+			carsServing.assign(floorNumber, car, spec.servedFloors.empty());
+		}
+		for (int floorNumber : spec.servedFloors) {
+			carsServing.assign(floorNumber, car, true);
+		}
+
+		if (parkingFloor[car] != 0 && !serves(car, parkingFloor[car])) {
+			parkingFloor[car] = 0;
+		}
+		if (!serves(car, currentFloor[car])) {
+			currentFloor[car] = lowestServedFloor(car);
+		}
+	}
+
+	/**
+	 * @brief Checks if a car serves a floor.
+	 *
+	 * @param car The index of the elevator.
+	 * @param floorNumber The floor.
+	 * @return True if the car stops at the floor, false otherwise.
+	 */
+	bool serves(int car, int floorNumber) const {
+		return carsServing.test(floorNumber, car);
+	}
+
+	/**
+	 * @brief Gets the cars serving a floor.
+	 *
+	 * @param floorNumber The floor.
+	 * @return The set of the cars that stop at the floor.
+	 */
+	CarMask getCarsServing(int floorNumber) const {
+		return carsServing[floorNumber];
+	}
+
+	/**
+	 * @brief Gets the cars serving every floor, e.g. to hand them to the FloorSet.
+	 *
+	 * @return The set of the cars serving each floor, at row floor number.
+	 */
+	const CarMasks& getServedFloorMasks() const {
+		return carsServing;
+	}
+
+	/**
+	 * @brief Checks if any car can take a passenger from one floor to another.
+	 *
+	 * @param startFloor The floor the passenger boards at.
+	 * @param endFloor The floor the passenger gets off at.
+	 * @return True if a car serves both floors, false otherwise.
+	 */
+	bool canAnyCarry(int startFloor, int endFloor) const {
+		return carsServing.intersects(startFloor, endFloor);
+	}
+
+	/**
+	 * @brief Checks if a car can take a passenger from one floor to another.
+	 *
+	 * @param car The index of the elevator.
+	 * @param startFloor The floor the passenger boards at.
+	 * @param endFloor The floor the passenger gets off at.
+	 * @return True if the car serves both floors, false otherwise.
+	 */
+	bool canCarry(int car, int startFloor, int endFloor) const {
+		return carsServing.test(startFloor, car) && carsServing.test(endFloor, car);
+	}
+
+	/**
+	 * @brief Gets the time it takes an elevator to move between floors, as given to the constructor.
+	 *
+	 * @return The time in seconds.
+	 */
+	int getSpeed() const {
+		return ELEVATOR_SPEED;
+	}
+
+	/**
+	 * @brief Gets the time it takes a car to move between floors.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The time in seconds.
+	 */
+	int getSpeed(int car) const {
+		return carSpeed[car];
+	}
+
+	/**
+	 * @brief Gets the time every car takes to move between floors, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of times per floor.
+	 */
+	const AlignedArray<int>& getSpeeds() const {
+		return carSpeed;
+	}
+
+	/**
+	 * @brief Gets the flight time of a run of floors from rest to rest.
+	 *
+	 * @param car The index of the elevator.
+	 * @param numOfFloors The length of the run, from 0 to the number of floors - 1.
+	 * @return The time in seconds.
+	 */
+	int getFlightTime(int car, int numOfFloors) const {
+		return flightTimes[static_cast<size_t>(car) * NUM_OF_FLOORS + numOfFloors];
+	}
+
+	/**
+	 * @brief Replaces the flight-time table of every car. Call it before the simulation starts.
+	 *
+	 * @param table The flight time of a run of d floors at index d, see CarKinematics::flightTimeTable.
+	 * @throw std::invalid_argument if the table does not have one entry per floor, does not start at 0 or
+	 *        does not grow by at least one second per floor.
+	 */
+	void setFlightTimes(const std::vector<int>& table) {
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			setFlightTimes(car, table);
+		}
+	}
+
+	/**
+	 * @brief Replaces the flight-time table of one car. Call it before the simulation starts.
+	 *
+	 * @param car The index of the elevator.
+	 * @param table The flight time of a run of d floors at index d, see CarKinematics::flightTimeTable.
+	 * @throw std::invalid_argument if the table does not have one entry per floor, does not start at 0 or
+	 *        does not grow by at least one second per floor.
+	 */
+	void setFlightTimes(int car, const std::vector<int>& table) {
+		if (table.size() != static_cast<size_t>(NUM_OF_FLOORS) || table[0] != 0) {
+			throw std::invalid_argument("The flight-time table needs one entry per floor, starting at 0");
+		}
+		for (size_t floors = 1; floors < table.size(); ++floors) {
+			if (table[floors] <= table[floors - 1]) {
+				throw std::invalid_argument("Every floor of a run must add at least one second of flight time");
+			}
+		}
+		std::copy(table.begin(), table.end(), flightTimes.begin() + static_cast<size_t>(car) * NUM_OF_FLOORS);
+	}
+
+	/**
+	 * @brief Sets whether cars fly straight to the next floor where anything could happen. Off by default.
+	 *
+	 * @param enabled True for event-driven travel, false to let the policy decide at every floor.
+	 */
+	void setEventDriven(bool enabled) {
+		eventDriven = enabled;
+	}
+
+	/**
+	 * @brief Replaces the fixed stop time with door and transfer times. Call it before the simulation starts.
+	 *
+	 * @param model The door timings and per-passenger transfer times.
+	 * @throw std::invalid_argument if a time is negative.
+	 */
+	void setDwellModel(const DwellModel& model) {
+		model.validate();
+		dwell = model;
+		dwellEnabled = true;
+	}
+
+	/**
+	 * @brief Replaces the default energy model. Call it before the simulation starts.
+	 *
+	 * @param model The masses, efficiencies and fixed costs of the cars.
+	 * @throw std::invalid_argument if the model is invalid, see EnergyModel::validate.
+	 */
+	void setEnergyModel(const EnergyModel& model) {
+		model.validate();
+		energyModel = model;
+	}
+
+	/**
+	 * @brief Gets the energy model the cars are charged with.
+	 *
+	 * @return The energy model.
+	 */
+	const EnergyModel& getEnergyModel() const {
+		return energyModel;
+	}
+
+	/**
+	 * @brief Gets the energy an elevator has used so far.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The energy, split by cause.
+	 */
+	const CarEnergy& getEnergy(int car) const {
+		return carEnergy[car];
+	}
+
+	/**
+	 * @brief Gets the energy all elevators have used so far.
+	 *
+	 * @return The energy, split by cause.
+	 */
+	CarEnergy getTotalEnergy() const {
+		CarEnergy total;
+		for (const CarEnergy& energy : carEnergy) {
+			total += energy;
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Adds a sink that receives every stop once the doors have closed.
+	 *
+	 * @param sink The sink to add. It must outlive the bank.
+	 */
+	void addStopSink(StopSink& sink) {
+		stopSinks.push_back(&sink);
+	}
+
+	/**
+	 * @brief Gets the time it takes an elevator to stop at a floor, as given to the constructor.
+	 *
+	 * @return The time in seconds.
+	 */
+	int getStopTime() const {
+		return ELEVATOR_STOP_TIME;
+	}
+
+	/**
+	 * @brief Gets the time it takes a car to stop at a floor.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The time in seconds.
+	 */
+	int getStopTime(int car) const {
+		return carStopTime[car];
+	}
+
+	/**
+	 * @brief Gets the time every car takes to stop at a floor, for policies that evaluate all cars in one pass.
+	 *
+	 * @return The cache-aligned array of stopping times.
+	 */
+	const AlignedArray<int>& getStopTimes() const {
+		return carStopTime;
+	}
+
+	/**
+	 * @brief Gets the passengers inside an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The riders of the elevator, grouped by destination floor.
+	 */
+	const RiderBuckets& getRiders(int car) const {
+		return riders[car];
+	}
+
+	/**
+	 * @brief Gets the maximum number of passengers an elevator can carry.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The capacity, of both decks together for a double-deck car.
+	 */
+	int getCapacity(int car) const {
+		return capacity[car] * decks[car];
+	}
+
+	/**
+	 * @brief Gets the number of passengers in one deck of an elevator.
+	 *
+	 * @param car The index of the elevator.
+	 * @param deck 0 for the lower deck, or the only one, and 1 for the upper deck.
+	 * @return The load of the deck, counting every member of a group.
+	 */
+	int getDeckLoad(int car, int deck) const {
+		return deck == 0 ? load[car] - upperLoad[car] : upperLoad[car];
+	}
+
+	/**
+	 * @brief Checks if one deck of an elevator has no room for another passenger.
+	 *
+	 * @param car The index of the elevator.
+	 * @param deck 0 for the lower deck, or the only one, and 1 for the upper deck.
+	 * @return True if the deck is full, false otherwise.
+	 */
+	bool isDeckFull(int car, int deck) const {
+		return getDeckLoad(car, deck) >= capacity[car];
+	}
+
+	/**
+	 * @brief Sets the maximum number of passengers every elevator can carry. Call it before the simulation starts.
+	 *
+	 * @param maxPassengers The capacity of each deck.
+	 * @throw std::invalid_argument if maxPassengers is less than 1.
+	 */
+	void setCapacity(int maxPassengers) {
+		if (maxPassengers < 1) {
+			throw std::invalid_argument("Elevator capacity must be at least 1");
+		}
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			capacity[car] = maxPassengers;
+		}
+	}
+
+	/**
+	 * @brief Lets groups that do not fit in a car board in part, the rest waiting for the next car.
+	 *
+	 * Off by default: a group waits for a car with room for all of it, unless it is larger than a deck.
+	 *
+	 * @param split True to split groups, false to board them whole.
+	 */
+	void setGroupSplitting(bool split) {
+		splitGroups = split;
+	}
+
+	/**
+	 * @brief Advances every active elevator that is due at the current time.
+	 *
+	 * Cars are advanced in index order, so the result is the same as updating each car in turn.
+	 * The policy is a template parameter, so its decisions are inlined into the kernel.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param numOfActiveCars The number of cars, counted from car 0, that are in service.
+	 * @param floors The floors of the building.
+	 * @param delivered The sink receiving passengers dropped off at their destination.
+	 * @param policy The dispatch policy deciding where each car goes and stops.
+	 */
+	template <typename Policy>
+	void update(int currentTime, int numOfActiveCars, FloorSet& floors, DeliverySink& delivered, Policy& policy) {
+		activeCars = numOfActiveCars;
+
+		// collect due cars without branching: a stopped or idle car acts every tick, the others when their timer expires
+		int dueCount = 0;
+		for (int car = 0; car < numOfActiveCars; ++car) {
+			dueCars[dueCount] = car;
+			dueCount += (state[car] == ElevatorState::STOPPED) | (state[car] == ElevatorState::IDLE) | (nextActionTime[car] == currentTime);
+		}
+
+		for (int i = 0; i < dueCount; ++i) {
+			updateCar(dueCars[i], currentTime, floors, delivered, policy);
+		}
+	}
+
+private:
+	const int NUM_OF_ELEVATORS; /**< The number of elevators in the bank. */
+	const int NUM_OF_FLOORS; /**< The number of floors in the building. */
+	const int ELEVATOR_SPEED; /**< The time it takes an elevator to move between floors, in seconds. */
+	const int ELEVATOR_STOP_TIME; /**< The time it takes for the elevator to stop at each floor. */
+
+	// hot state, one entry per car
+	AlignedArray<int> currentFloor; /**< The current floor where each elevator is located. */
+	AlignedArray<int> nextActionTime; /**< The time for the next action of each elevator. */
+	AlignedArray<ElevatorState> state; /**< The current state of each elevator. */
+	AlignedArray<ElevatorDirection> direction; /**< The current direction of each elevator. */
+	AlignedArray<int> load; /**< The number of passengers inside each elevator. */
+	AlignedArray<int> dueCars; /**< Scratch list of the cars due in the current update. */
+	AlignedArray<int> parkingFloor; /**< The floor each elevator returns to when it runs out of work, or 0. */
+	AlignedArray<int> targetFloor; /**< The floor each moving elevator arrives at when its timer expires. */
+	AlignedArray<int> runLength; /**< The number of floors each elevator has moved since it last stopped or turned. */
+	AlignedArray<int> carSpeed; /**< The time each elevator takes to move between floors. */
+	AlignedArray<int> carStopTime; /**< The time each elevator takes to stop at a floor. */
+	AlignedArray<int> capacity; /**< The maximum number of passengers in each deck of each elevator. */
+	AlignedArray<int> decks; /**< The number of decks of each elevator. */
+	AlignedArray<int> upperLoad; /**< The number of passengers in the upper deck of each elevator. */
+	int activeCars = 0; /**< The number of cars in service during the current update. */
+	std::pmr::vector<int> flightTimes; /**< The flight time of a run of d floors from rest to rest, at index car * NUM_OF_FLOORS + d. */
+	CarMasks carsServing; /**< The set of the cars serving each floor, at row floor number. */
+	bool eventDriven = false; /**< Whether cars fly straight to the next floor where anything could happen. */
+	AlignedArray<int> doorState; /**< Whether the doors of each elevator are closed, open after arriving, or closing. */
+	DwellModel dwell; /**< The door and transfer times, used if dwellEnabled is set. */
+	bool dwellEnabled = false; /**< Whether stops take their time from the dwell model rather than ELEVATOR_STOP_TIME. */
+	static constexpr int DOORS_CLOSED = 0; /**< Door state of a car that is not stopping. */
+	static constexpr int DOORS_OPEN = 1; /**< Door state of a car that has just arrived at a stop. */
+	static constexpr int DOORS_CLOSING = 2; /**< Door state of a car holding its doors for the passengers of a stop. */
+
+	std::pmr::vector<RiderBuckets> riders; /**< The passengers inside each elevator, grouped by destination floor. */
+	std::pmr::vector<ElevatorLog> logs; /**< Cold side table with the logger of each elevator. */
+	std::pmr::vector<StopEvent> openStops; /**< Cold side table with the stop each elevator is making. */
+	std::pmr::vector<StopSink*> stopSinks; /**< The sinks receiving finished stops. */
+	std::pmr::vector<CarEnergy> carEnergy; /**< Cold side table with the energy each elevator has used. */
+	EnergyModel energyModel; /**< The model the energy of the elevators is charged with. */
+	bool dynamicParking = false; /**< Whether parking floors are given up with work and chosen anew when cars run out of it. */
+	std::pmr::vector<int> parkingRequests; /**< The cars that ran out of work in the current update without a parking floor. */
+	bool splitGroups = false; /**< Whether groups that do not fit board in part. */
+
+	/**
+	 * @brief Gets the lowest floor a car serves.
+	 *
+	 * @param car The index of the elevator.
+	 * @return The floor number, 1 if the car serves no floor.
+	 */
+	int lowestServedFloor(int car) const {
+		for (int floorNumber = 1; floorNumber <= NUM_OF_FLOORS; ++floorNumber) {
+			if (serves(car, floorNumber)) {
+				return floorNumber;
+			}
+		}
+		return 1;
+	}
+
+	/**
+	 * @brief Updates the state of one elevator.
+	 *
+	 * This method handles the logic for moving the elevator, picking up and dropping off passengers,
+	 * and updating the elevator state. Where the car goes and where it stops is left to the policy.
+	 *
+	 * @param car The index of the elevator.
+	 * @param currentTime The current simulation time in seconds.
+	 * @param floors The floors of the building.
+	 * @param delivered The sink receiving passengers dropped off at their destination.
+	 * @param policy The dispatch policy.
+	 */
+	template <typename Policy>
+	void updateCar(int car, int currentTime, FloorSet& floors, DeliverySink& delivered, Policy& policy) {
+		switch (state[car]) {
+		case ElevatorState::IDLE: // Idle State: a stopped car with nothing to do
+		case ElevatorState::STOPPED: { // Stopped State
+			const int arrivingLoad = load[car];
+			const bool closing = doorState[car] == DOORS_CLOSING;
+
+			// Discharge passengers if there are any that get off at this floor
+			if (!riders[car].empty()) {
+				dropOffPassengers(car, currentTime, delivered);
+			}
+			const int alighted = arrivingLoad - load[car];
+
+			// let the policy pick the direction we board in, e.g. turn around at the top or bottom floor
+			direction[car] = policy.boardingDirection(*this, car, floors);
+
+			// If there are passengers waiting on this floor and going in the same direction, pick them up
+			// if the elevator is not at capacity, and unless the doors are closing and may not reopen
+			const int remainingLoad = load[car];
+			const bool waiting = floors.hasWaitingPassengers(currentFloor[car])
+				|| (decks[car] == 2 && floors.hasWaitingPassengers(getUpperDeckFloor(car)));
+			if (waiting && (!closing || dwell.reopen)) {
+				pickUpPassengers(car, floors, currentTime, policy);
+				policy.afterBoarding(*this, car, floors);
+			}
+
+			// keep the doors open for the passengers getting off and on
+			if (holdDoors(car, currentTime, alighted, load[car] - remainingLoad)) {
+				break;
+			}
+
+			// let the policy pick where to go next; staying stopped waits here until the next tick
+			depart(car, policy.nextMove(*this, car, floors), currentTime, floors, policy);
+			break;
+		}
+
+		case ElevatorState::STOPPING: // Stopping State
+			// the stopping time has elapsed, the kernel only calls us when nextActionTime == currentTime
+			state[car] = ElevatorState::STOPPED;
+			break;
+
+		case ElevatorState::MOVING_UP: // Moving Up State
+		case ElevatorState::MOVING_DOWN: // Moving Down State
+			// The elevator has reached its next action time, arrive at the floor it was heading for
+			currentFloor[car] = targetFloor[car];
+
+			// Check if the elevator should stop at this floor, otherwise let the policy pick how to continue
+			if (policy.shouldStop(*this, car, floors)) {
+				stop(car, currentTime);
+			}
+			else {
+				ElevatorState move = policy.nextMove(*this, car, floors);
+				if (move == ElevatorState::STOPPED) {
+					stop(car, currentTime);
+				}
+				else {
+					depart(car, move, currentTime, floors, policy);
+				}
+			}
+			break;
+		} // end of switch
+	}
+
+	/**
+	 * @brief Puts an elevator in the state chosen by the policy.
+	 *
+	 * A car that turns around has to come to rest first, so its run starts over.
+	 *
+	 * @param car The index of the elevator.
+	 * @param move MOVING_UP or MOVING_DOWN to travel, STOPPED to stay at the current floor.
+	 * @param currentTime The current simulation time in seconds.
+	 * @param floors The floors of the building.
+	 * @param policy The dispatch policy.
+	 */
+	template <typename Policy>
+	void depart(int car, ElevatorState move, int currentTime, FloorSet& floors, Policy& policy) {
+		const bool wasIdle = state[car] == ElevatorState::IDLE;
+		state[car] = move;
+		if (move == ElevatorState::STOPPED) {
+			if (load[car] == 0 && doorState[car] == DOORS_CLOSED) {
+				idle(car);
+			}
+			return;
+		}
+		if (wasIdle && dynamicParking) {
+			// a parked car leaving for a call gives its parking floor up
+			parkingFloor[car] = 0;
+		}
+
+		ElevatorDirection heading = move == ElevatorState::MOVING_UP ? ElevatorDirection::UP : ElevatorDirection::DOWN;
+		if (heading != direction[car]) {
+			runLength[car] = 0;
+		}
+		direction[car] = heading;
+
+		int floorsAhead = eventDriven ? flightLength(car, floors, policy) : 1;
+		targetFloor[car] = currentFloor[car] + (heading == ElevatorDirection::UP ? floorsAhead : -floorsAhead);
+		energyModel.chargeRun(carEnergy[car], floorsAhead, heading, load[car], getCapacity(car), runLength[car] == 0);
+		const int* flight = &flightTimes[static_cast<size_t>(car) * NUM_OF_FLOORS];
+		nextActionTime[car] = currentTime + flight[runLength[car] + floorsAhead] - flight[runLength[car]];
+		runLength[car] += floorsAhead;
+	}
+
+	/**
+	 * @brief Lets an empty car with closed doors and nothing to do wait, and charges it standby power until the next tick.
+	 *
+	 * The car goes IDLE where it is, unless dynamic parking is on and it has no parking floor yet; then it
+	 * stays STOPPED and asks for one.
+	 *
+	 * @param car The index of the elevator.
+	 */
+	void idle(int car) {
+		carEnergy[car].standby += energyModel.standbyEnergy(1);
+		if (dynamicParking && parkingFloor[car] == 0) {
+			parkingRequests.push_back(car);
+			return;
+		}
+		state[car] = ElevatorState::IDLE;
+	}
+
+	/**
+	 * @brief Finds how far a departing car can fly before it reaches a floor where it may have to stop or turn.
+	 *
+	 * @param car The index of the elevator, with its direction set to the way it is leaving.
+	 * @param floors The floors of the building.
+	 * @param policy The dispatch policy.
+	 * @return The number of floors to the nearest such floor, at least 1.
+	 */
+	template <typename Policy>
+	int flightLength(int car, const FloorSet& floors, Policy& policy) const {
+		const int from = currentFloor[car];
+		const bool up = direction[car] == ElevatorDirection::UP;
+		int target = up ? NUM_OF_FLOORS : 1;
+		auto consider = [&](int floorNumber) {
+			if (floorNumber != 0 && (up ? floorNumber > from && floorNumber < target : floorNumber < from && floorNumber > target)) {
+				target = floorNumber;
+			}
+		};
+
+		consider(up ? riders[car].findDestinationAbove(from) : riders[car].findDestinationBelow(from));
+		int call = up ? floors.findHallCallAbove(from) : floors.findHallCallBelow(from);
+		consider(call);
+		if (up && decks[car] == 2 && call != 0) {
+			// the upper deck reaches a call above one floor earlier
+			consider(call - 1);
+		}
+		consider(parkingFloor[car]);
+		consider(policy.flightWaypoint(*this, car));
+		return std::max(1, up ? target - from : from - target);
+	}
+
+	/**
+	 * @brief Starts stopping an elevator at its current floor.
+	 *
+	 * @param car The index of the elevator.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void stop(int car, int currentTime) {
+		state[car] = ElevatorState::STOPPING;
+		runLength[car] = 0;
+		doorState[car] = DOORS_OPEN;
+		openStops[car] = StopEvent{ car, currentFloor[car], currentTime };
+		openStops[car].doorTime = dwellEnabled ? dwell.doorOpenTime : carStopTime[car];
+		int stopTime = dwellEnabled ? dwell.openingTicks() : carStopTime[car];
+		nextActionTime[car] = currentTime + stopTime - 1; // -1 second to account for stopped state which takes 1 second to execute
+	}
+
+	/**
+	 * @brief Holds the doors of a stopped elevator open for the passengers who just got off and on.
+	 *
+	 * Without a dwell model the stop ends here. With one, the car stands for the transfer and closing time,
+	 * plus an opening if the doors were closed or closing, and then acts again; the stop ends when it acts
+	 * with nobody getting off or on.
+	 *
+	 * @param car The index of the elevator.
+	 * @param currentTime The current simulation time in seconds.
+	 * @param alighted The number of passengers who just got off.
+	 * @param boarded The number of passengers who just got on.
+	 * @return True if the car holds its doors, false if it may leave.
+	 */
+	bool holdDoors(int car, int currentTime, int alighted, int boarded) {
+		StopEvent& stop = openStops[car];
+		if (!dwellEnabled || (alighted + boarded == 0 && doorState[car] != DOORS_OPEN)) {
+			if (doorState[car] != DOORS_CLOSED) {
+				stop.alighted += alighted;
+				stop.boarded += boarded;
+				finishStop(car, currentTime);
+			}
+			return false;
+		}
+
+		double doorTime = dwell.doorCloseTime;
+		if (doorState[car] == DOORS_CLOSED) {
+			// a car waiting with closed doors opens them for a new passenger
+			stop = StopEvent{ car, currentFloor[car], currentTime };
+			doorTime += dwell.doorOpenTime;
+		}
+		else if (doorState[car] == DOORS_CLOSING && boarded > 0) {
+			++stop.reopenings;
+			doorTime += dwell.doorOpenTime;
+		}
+		double transferTime = dwell.transferTime(alighted, boarded);
+		stop.alighted += alighted;
+		stop.boarded += boarded;
+		stop.doorTime += doorTime;
+		stop.transferTime += transferTime;
+
+		doorState[car] = DOORS_CLOSING;
+		state[car] = ElevatorState::STOPPING;
+		nextActionTime[car] = currentTime + std::max(2, static_cast<int>(std::lround(doorTime + transferTime))) - 1;
+		return true;
+	}
+
+	/**
+	 * @brief Ends the stop of an elevator and reports it to the stop sinks.
+	 *
+	 * @param car The index of the elevator.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void finishStop(int car, int currentTime) {
+		StopEvent& stop = openStops[car];
+		stop.duration = currentTime - stop.arrivalTime;
+		for (StopSink* sink : stopSinks) {
+			sink->record(stop);
+		}
+		doorState[car] = DOORS_CLOSED;
+	}
+
+	/**
+	 * @brief Picks up passengers waiting on the elevator's floor.
+	 *
+	 * This method picks up passengers waiting on the elevator's floor who are going in the same direction as the elevator
+	 * whom the car can carry, and whom the policy lets board this car.
+	 *
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param currentTime The current simulation time in seconds.
+	 * @param policy The dispatch policy.
+	 */
+	template <typename Policy>
+	void pickUpPassengers(int car, FloorSet& floors, int currentTime, Policy& policy) {
+		// pick up passengers that are going in the same direction, up to the capacity of each deck, counting group members
+		const size_t splitAbove = splitGroups ? 0 : static_cast<size_t>(capacity[car]);
+		for (int deck = 0; deck < decks[car] && currentFloor[car] + deck <= NUM_OF_FLOORS; ++deck) {
+			const int deckLoad = getDeckLoad(car, deck);
+			size_t freeSpace = deckLoad < capacity[car] ? capacity[car] - deckLoad : 0;
+			auto boardingShare = [&](const Passenger& passenger) -> size_t {
+				if (passenger.getEndFloor() - deck < 1 || !canCarry(car, passenger.getStartFloor(), passenger.getEndFloor())) {
+					return 0;
+				}
+				return static_cast<size_t>(std::max(0, policy.boardingShare(*this, car, passenger)));
+				};
+			floors.board(currentFloor[car] + deck, direction[car], freeSpace, boardingShare, [&](Passenger& passenger) {
+				passenger.calculateWaitTime(currentTime);
+				riders[car].push(passenger, passenger.getEndFloor() - deck);
+				load[car] += passenger.getGroupSize();
+				upperLoad[car] += deck * passenger.getGroupSize();
+				parkingFloor[car] = dynamicParking ? 0 : parkingFloor[car];
+				policy.onBoarded(*this, car, passenger);
+
+				logs[car].logStatusPickup(currentTime, currentFloor[car], direction[car], state[car], riders[car], passenger);
+				}, splitAbove);
+		}
+	}
+
+	/**
+	 * @brief Drops off passengers at the elevator's floor.
+	 *
+	 * This method drops off passengers inside the elevator whose destination is the current floor.
+	 * Only the riders bucketed under this floor are visited, in the order they boarded.
+	 *
+	 * @param car The index of the elevator.
+	 * @param currentTime The current simulation time in seconds.
+	 * @param delivered The sink receiving the dropped off passengers.
+	 */
+	void dropOffPassengers(int car, int currentTime, DeliverySink& delivered) {
+		riders[car].unload(currentFloor[car], [&](Passenger& passenger) {
+			load[car] -= passenger.getGroupSize();
+			upperLoad[car] -= passenger.getEndFloor() != currentFloor[car] ? passenger.getGroupSize() : 0;
+			passenger.calculateTravelTime(currentTime);
+			delivered.deliver(passenger, currentTime);
+
+			logs[car].logStatusDropoff(currentTime, currentFloor[car], direction[car], state[car], riders[car], passenger);
+			});
+	}
+};
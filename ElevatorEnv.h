@@ -0,0 +1,345 @@
+/**
+ * @file ElevatorEnv.h
+ * @brief Declaration and implementation of the ExternalControlPolicy and ElevatorEnv classes.
+ *
+ * The ElevatorEnv class wraps a batch of independent quiet simulations of the same building behind a
+ * reset/step interface, so an outside controller, e.g. a learning agent, can drive the cars one step at a
+ * time. Every step takes one action per car of every environment and advances all environments by the
+ * same number of seconds, spread over a persistent thread pool.
+ *
+ * The observations of all environments are laid out contiguously, OBSERVATION_SIZE floats per environment:
+ * - [0, N): the floor of each car.
+ * - [N, 2N): the number of riders in each car.
+ * - [2N, 2N + F): 1 if floor f + 1 has an up hall call, 0 otherwise.
+ * - [2N + F, 2N + 2F): the same for down hall calls.
+ * - [2N + 2F, 2N + 3F): the number of passengers waiting on each floor.
+ * where N is the number of cars and F the number of floors.
+ *
+ * The reward of a step is minus the passenger-seconds spent waiting or riding during it. An environment is
+ * done when its trace has been delivered or its time limit is reached, and is then reset at once, so the
+ * observation returned with done set is already the first one of the next episode.
+ */
+
+#pragma once
+#include "Building.h"
+#include "DispatchPolicy.h"
+#include "DeliverySink.h"
+#include "ElevatorBank.h"
+#include "FloorSet.h"
+#include "Passenger.h"
+#include "ThreadPool.h"
+#include "ElevatorState.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief A policy whose cars follow actions set from outside the simulation.
+ *
+ * Each car reads its action from an array owned by the caller:
+ * - HOLD: stop at the next floor, or stay at the current one.
+ * - UP, DOWN: travel that way, turning around at the top and bottom floors only by holding there.
+ * A moving car still stops for riders leaving at a floor and for hall calls in its direction, as under
+ * collective control, and stops to turn around when its action changes direction.
+ */
+class ExternalControlPolicy : public DispatchPolicy<ExternalControlPolicy> {
+public:
+	static constexpr int HOLD = 0; // Action of a car that stops or stays.
+	static constexpr int UP = 1; // Action of a car that travels up.
+	static constexpr int DOWN = 2; // Action of a car that travels down.
+
+	/**
+	 * @brief Points the policy at the actions of its cars.
+	 *
+	 * @param carActions One action per car. It must outlive the next simulated second.
+	 */
+	void setActions(const int* carActions) {
+		actions = carActions;
+	}
+
+	/**
+	 * @brief Chooses the direction a stopped car boards in: the direction of its action, or its last one when holding.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return The boarding direction.
+	 */
+	ElevatorDirection boardingDirection(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		if (actions[car] == UP) {
+			return ElevatorDirection::UP;
+		}
+		if (actions[car] == DOWN) {
+			return ElevatorDirection::DOWN;
+		}
+		return bank.getDirection(car);
+	}
+
+	/**
+	 * @brief Chooses the next move of a car from its action.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return MOVING_UP or MOVING_DOWN as the action says, STOPPED when holding or at the end of the shaft.
+	 */
+	ElevatorState nextMove(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		if (actions[car] == UP && bank.getCurrentFloor(car) < bank.getNumOfFloors()) {
+			return ElevatorState::MOVING_UP;
+		}
+		if (actions[car] == DOWN && bank.getCurrentFloor(car) > 1) {
+			return ElevatorState::MOVING_DOWN;
+		}
+		return ElevatorState::STOPPED;
+	}
+
+	/**
+	 * @brief Checks if a car should stop at the floor it has just reached.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @return True if the collective-control rule says so or the action no longer goes the car's way, false otherwise.
+	 */
+	bool shouldStop(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		int wanted = bank.getDirection(car) == ElevatorDirection::UP ? UP : DOWN;
+		return actions[car] != wanted || DispatchPolicy<ExternalControlPolicy>::shouldStop(bank, car, floors);
+	}
+
+private:
+	const int* actions = nullptr; // One action per car, owned by the caller.
+};
+
+class ElevatorEnv {
+public:
+	/**
+	 * @brief Constructs a batch of environments simulating the same building and trace, and resets them.
+	 *
+	 * @param numOfEnvs The number of environments.
+	 * @param numOfFloors The number of floors in the building.
+	 * @param numOfElevators The number of elevators in the building.
+	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+	 * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+	 * @param trace The passengers of every episode, in order of arrival. It must outlive the environments.
+	 * @param timeLimit The length of an episode in seconds, at most.
+	 * @param stepSeconds The number of seconds simulated per step.
+	 * @param numOfThreads The number of threads stepping the environments, 0 for one per hardware thread.
+	 * @throw std::invalid_argument if numOfEnvs, timeLimit or stepSeconds is not positive.
+	 */
+	ElevatorEnv(int numOfEnvs, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+		const std::vector<Passenger>& trace, int timeLimit, int stepSeconds = 1, unsigned numOfThreads = 0)
+		: NUM_OF_ENVS(numOfEnvs), NUM_OF_FLOORS(numOfFloors), NUM_OF_ELEVATORS(numOfElevators),
+		ELEVATOR_SPEED(elevatorSpeed), ELEVATOR_STOPPING_TIME(elevatorStoppingTime),
+		OBSERVATION_SIZE(2 * numOfElevators + 3 * numOfFloors), trace(trace), timeLimit(timeLimit),
+		stepSeconds(stepSeconds), pool(numOfThreads) {
+		if (numOfEnvs < 1 || timeLimit < 1 || stepSeconds < 1) {
+			throw std::invalid_argument("An environment batch needs at least one environment, second per step and second per episode");
+		}
+		envs.resize(numOfEnvs);
+		observations.resize(static_cast<size_t>(numOfEnvs) * OBSERVATION_SIZE);
+		rewards.resize(numOfEnvs);
+		dones.resize(numOfEnvs);
+		reset();
+	}
+
+	/**
+	 * @brief Starts a new episode in every environment.
+	 *
+	 * @return The first observations, OBSERVATION_SIZE floats per environment.
+	 */
+	const float* reset() {
+		pool.run(NUM_OF_ENVS, [this](size_t env) {
+			resetEnv(env);
+			observe(env);
+			});
+		return observations.data();
+	}
+
+	/**
+	 * @brief Advances every environment by one step.
+	 *
+	 * @param actions One ExternalControlPolicy action per car, numOfElevators per environment, laid out contiguously.
+	 *        An unknown action counts as HOLD.
+	 * @return The observations after the step, OBSERVATION_SIZE floats per environment.
+	 */
+	const float* step(const int* actions) {
+		pool.run(NUM_OF_ENVS, [this, actions](size_t env) {
+			stepEnv(env, actions + env * NUM_OF_ELEVATORS);
+			});
+		return observations.data();
+	}
+
+	/**
+	 * @brief Gets the number of environments.
+	 *
+	 * @return The number of environments.
+	 */
+	int size() const {
+		return NUM_OF_ENVS;
+	}
+
+	/**
+	 * @brief Gets the number of floats observed per environment.
+	 *
+	 * @return The observation size.
+	 */
+	int getObservationSize() const {
+		return OBSERVATION_SIZE;
+	}
+
+	/**
+	 * @brief Gets the observations after the last step or reset.
+	 *
+	 * @return OBSERVATION_SIZE floats per environment.
+	 */
+	const float* getObservations() const {
+		return observations.data();
+	}
+
+	/**
+	 * @brief Gets the reward of every environment in the last step.
+	 *
+	 * @return One reward per environment.
+	 */
+	const float* getRewards() const {
+		return rewards.data();
+	}
+
+	/**
+	 * @brief Gets which environments finished an episode in the last step.
+	 *
+	 * @return One flag per environment, 1 if its episode ended and it was reset.
+	 */
+	const std::uint8_t* getDones() const {
+		return dones.data();
+	}
+
+	/**
+	 * @brief Gets the number of passengers delivered in the current episode of an environment.
+	 *
+	 * @param env The index of the environment.
+	 * @return The number of delivered passengers.
+	 */
+	size_t getDeliveredCount(int env) const {
+		return envs[env].delivered->getDeliveredCount();
+	}
+
+private:
+	/**
+	 * @brief One simulation of the batch.
+	 */
+	struct Environment {
+		std::unique_ptr<Building> building; // The simulated building of the current episode.
+		std::unique_ptr<DeliveryPipeline> delivered; // Counts the passengers delivered in the current episode.
+		ExternalControlPolicy policy; // Moves the cars as the actions say.
+		std::vector<int> actions; // The actions of the current step, with unknown actions replaced by HOLD.
+	};
+
+	const int NUM_OF_ENVS; // The number of environments.
+	const int NUM_OF_FLOORS; // The number of floors in the building.
+	const int NUM_OF_ELEVATORS; // The number of elevators in the building.
+	const int ELEVATOR_SPEED; // The speed of the elevators (in seconds per floor).
+	const int ELEVATOR_STOPPING_TIME; // The time taken for the elevator to stop at a floor (in seconds).
+	const int OBSERVATION_SIZE; // The number of floats observed per environment.
+	const std::vector<Passenger>& trace; // The passengers of every episode.
+	const int timeLimit; // The length of an episode in seconds, at most.
+	const int stepSeconds; // The number of seconds simulated per step.
+	std::vector<Environment> envs; // The environments.
+	std::vector<float> observations; // OBSERVATION_SIZE floats per environment.
+	std::vector<float> rewards; // The reward of every environment in the last step.
+	std::vector<std::uint8_t> dones; // Whether every environment finished an episode in the last step.
+	ThreadPool pool; // The threads stepping the environments.
+
+	/**
+	 * @brief Starts a new episode in one environment.
+	 *
+	 * @param env The index of the environment.
+	 */
+	void resetEnv(size_t env) {
+		Environment& environment = envs[env];
+		environment.building.reset();
+		environment.building = std::make_unique<Building>(NUM_OF_FLOORS, NUM_OF_ELEVATORS, ELEVATOR_SPEED,
+			ELEVATOR_STOPPING_TIME, "env_" + std::to_string(env), trace, true);
+		environment.delivered = std::make_unique<DeliveryPipeline>();
+		environment.actions.assign(NUM_OF_ELEVATORS, ExternalControlPolicy::HOLD);
+		environment.policy.setActions(environment.actions.data());
+		rewards[env] = 0.0f;
+		dones[env] = 0;
+	}
+
+	/**
+	 * @brief Advances one environment by one step, resetting it if its episode ends.
+	 *
+	 * @param env The index of the environment.
+	 * @param carActions The actions of its cars.
+	 */
+	void stepEnv(size_t env, const int* carActions) {
+		Environment& environment = envs[env];
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			int action = carActions[car];
+			environment.actions[car] = action == ExternalControlPolicy::UP || action == ExternalControlPolicy::DOWN ? action : ExternalControlPolicy::HOLD;
+		}
+
+		Building& building = *environment.building;
+		double passengerSeconds = 0.0;
+		bool done = false;
+		for (int second = 0; second < stepSeconds && !done; ++second) {
+			building.step(environment.policy, *environment.delivered);
+			passengerSeconds += building.getFloors().getWaitingCount() + ridingCount(building.getElevators());
+			done = building.isFinished() || building.getElapsedTime() >= timeLimit;
+		}
+
+		if (done) {
+			resetEnv(env);
+		}
+		rewards[env] = static_cast<float>(-passengerSeconds);
+		dones[env] = done ? 1 : 0;
+		observe(env);
+	}
+
+	/**
+	 * @brief Writes the observation of one environment into the batch.
+	 *
+	 * @param env The index of the environment.
+	 */
+	void observe(size_t env) {
+		const ElevatorBank& bank = envs[env].building->getElevators();
+		const FloorSet& floors = envs[env].building->getFloors();
+		float* observation = observations.data() + env * OBSERVATION_SIZE;
+
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			observation[car] = static_cast<float>(bank.getCurrentFloor(car));
+			observation[NUM_OF_ELEVATORS + car] = static_cast<float>(bank.getLoads()[car]);
+		}
+
+		float* upCalls = observation + 2 * NUM_OF_ELEVATORS;
+		float* downCalls = upCalls + NUM_OF_FLOORS;
+		float* waiting = downCalls + NUM_OF_FLOORS;
+		if (!floors.hasWaitingPassengers()) {
+			std::fill(upCalls, waiting + NUM_OF_FLOORS, 0.0f);
+			return;
+		}
+		for (int floorNumber = 1; floorNumber <= NUM_OF_FLOORS; ++floorNumber) {
+			upCalls[floorNumber - 1] = floors.hasHallCall(floorNumber, ElevatorDirection::UP) ? 1.0f : 0.0f;
+			downCalls[floorNumber - 1] = floors.hasHallCall(floorNumber, ElevatorDirection::DOWN) ? 1.0f : 0.0f;
+			waiting[floorNumber - 1] = static_cast<float>(floors.getWaitingCount(floorNumber));
+		}
+	}
+
+	/**
+	 * @brief Counts the passengers riding in the cars.
+	 *
+	 * @param bank The elevators of the building.
+	 * @return The number of riders.
+	 */
+	int ridingCount(const ElevatorBank& bank) const {
+		int riders = 0;
+		for (int car = 0; car < NUM_OF_ELEVATORS; ++car) {
+			riders += bank.getLoads()[car];
+		}
+		return riders;
+	}
+};
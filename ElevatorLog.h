@@ -0,0 +1,111 @@
+/**
+ * @file ElevatorLog.h
+ * @brief Declaration and implementation of the ElevatorLog class.
+ *
+ * The ElevatorLog class holds the cold, rarely touched data of one elevator: its log file names and logger.
+ * It lives in a side table of the ElevatorBank so the hot per-car state stays small and contiguous.
+ */
+
+#pragma once
+#include "Passenger.h"
+#include "ElevatorState.h"
+#include "RiderBuckets.h"
+#include "SimulationLog.h"
+#include "spdlog/spdlog.h"
+#include <spdlog/sinks/basic_file_sink.h>
+#include <memory>
+#include <string>
+
+class ElevatorLog {
+public:
+	/**
+	 * @brief Constructs an ElevatorLog and opens its log file.
+	 *
+	 * @param elevatorNum The unique identifier for the elevator.
+	 * @param logFileName The file name prefix for logging elevator activities.
+	 * @param quiet True to drop every message instead of opening a log file.
+	 */
+	ElevatorLog(int elevatorNum, const std::string& logFileName, bool quiet = false)
+		: logFileName{ logFileName + "_elevator_" + std::to_string(elevatorNum) },
+		logFileLocation{ "logs/" + this->logFileName + ".txt" } {
+		log = openSimulationLogger(this->logFileName, this->logFileLocation, quiet);
+	}
+
+	/**
+	 * @brief Logs the status of picking up a passenger.
+	 *
+	 * This method logs information about picking up a passenger, including the current time, floor, direction,
+	 * elevator state, number of passengers, and the passenger's ID and start floor.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param currentFloor The floor where the elevator is.
+	 * @param direction The direction of the elevator.
+	 * @param state The state of the elevator.
+	 * @param passengers The passengers inside the elevator.
+	 * @param passenger The passenger being picked up.
+	 */
+	void logStatusPickup(int currentTime, int currentFloor, ElevatorDirection direction, ElevatorState state,
+		const RiderBuckets& passengers, const Passenger& passenger) {
+		if (!log->should_log(spdlog::level::info)) {
+			return;
+		}
+		logStatus(currentTime, currentFloor, direction, state, passengers);
+		log->info("Passenger {} picked up at floor {} at time {}", passenger.getPassengerID(), passenger.getStartFloor(), currentTime);
+		log->info("\n");
+	}
+
+	/**
+	 * @brief Logs the status of dropping off a passenger.
+	 *
+	 * This method logs information about dropping off a passenger, including the current time, floor, direction,
+	 * elevator state, number of passengers, and the passenger's ID and end floor.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param currentFloor The floor where the elevator is.
+	 * @param direction The direction of the elevator.
+	 * @param state The state of the elevator.
+	 * @param passengers The passengers inside the elevator.
+	 * @param passenger The passenger being dropped off.
+	 */
+	void logStatusDropoff(int currentTime, int currentFloor, ElevatorDirection direction, ElevatorState state,
+		const RiderBuckets& passengers, const Passenger& passenger) {
+		if (!log->should_log(spdlog::level::info)) {
+			return;
+		}
+		logStatus(currentTime, currentFloor, direction, state, passengers);
+		log->info("Passenger {} dropped off at floor {} at time {}", passenger.getPassengerID(), passenger.getEndFloor(), currentTime);
+		log->info("\n");
+	}
+
+private:
+	const std::string logFileName; /**< The file name for logging elevator activities. */
+	const std::string logFileLocation; /**< The file location for logging elevator activities. */
+	std::shared_ptr<spdlog::logger> log; /**< A logger for recording elevator activities. */
+
+	/**
+	 * @brief Logs the common part of a pickup or drop-off entry.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param currentFloor The floor where the elevator is.
+	 * @param direction The direction of the elevator.
+	 * @param state The state of the elevator.
+	 * @param passengers The passengers inside the elevator.
+	 */
+	void logStatus(int currentTime, int currentFloor, ElevatorDirection direction, ElevatorState state, const RiderBuckets& passengers) {
+		log->info("Time: {}", currentTime);
+		log->info("Current floor: {}", currentFloor);
+		log->info("Direction: {}", direction == ElevatorDirection::UP ? "UP" : "DOWN");
+		log->info("State: {}", state == ElevatorState::STOPPED ? "STOPPED" : state == ElevatorState::MOVING_UP ? "MOVING UP"
+			: state == ElevatorState::MOVING_DOWN ? "MOVING DOWN" : "IDLE");
+		log->info("Number of passengers: {}", passengers.getHeadcount());
+		log->info("Passengers On Board: ");
+		passengers.forEach([this](const Passenger& rider) {
+			if (rider.getGroupSize() == 1) {
+				log->info("\tPassenger {}", rider.getPassengerID());
+			}
+			else {
+				log->info("\tPassenger {} (group of {})", rider.getPassengerID(), rider.getGroupSize());
+			}
+			});
+	}
+};
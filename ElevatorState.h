@@ -1,13 +1,15 @@
 #pragma once
+#include <cstdint>
 
-enum class ElevatorState {
+enum class ElevatorState : std::uint8_t {
 	STOPPED,
 	STOPPING,
 	MOVING_UP,
 	MOVING_DOWN,
+	IDLE,
 };
 
-enum class ElevatorDirection {
+enum class ElevatorDirection : std::uint8_t {
 	UP,
 	DOWN,
 };
@@ -0,0 +1,142 @@
+/**
+ * @file EnergyModel.h
+ * @brief Declaration and implementation of the energy model of the cars.
+ *
+ * An EnergyModel prices what a car does in kWh. A run costs the drive losses of every floor moved plus
+ * the work of lifting the imbalance between the car and its counterweight, which balances the empty car and
+ * a fraction of the rated load. A car heavier than its counterweight going up, or lighter going down,
+ * draws that work from the mains through the drive; the other two cases overhaul the motor, and a
+ * regenerative drive returns part of the work. Every start from rest adds a fixed acceleration and braking
+ * cost, and a car standing empty with its doors closed draws standby power.
+ *
+ * The bank charges each car as it departs and while it stands idle, and keeps the figures in a CarEnergy.
+ */
+
+#pragma once
+#include "ElevatorState.h"
+#include <stdexcept>
+
+/**
+ * @brief The energy a car has used, split by cause, in kWh.
+ */
+struct CarEnergy {
+	double motoring = 0.0; // Energy drawn while moving, drive losses included.
+	double regenerated = 0.0; // Energy returned to the mains on overhauling runs.
+	double startStop = 0.0; // Energy spent accelerating and braking.
+	double standby = 0.0; // Energy drawn standing idle.
+
+	/**
+	 * @brief Gets the net energy the car has drawn.
+	 *
+	 * @return The energy in kWh.
+	 */
+	double total() const {
+		return motoring + startStop + standby - regenerated;
+	}
+
+	/**
+	 * @brief Adds the energy of another car.
+	 *
+	 * @param other The energy to add.
+	 * @return This object.
+	 */
+	CarEnergy& operator+=(const CarEnergy& other) {
+		motoring += other.motoring;
+		regenerated += other.regenerated;
+		startStop += other.startStop;
+		standby += other.standby;
+		return *this;
+	}
+};
+
+/**
+ * @brief Masses, efficiencies and fixed costs of the cars.
+ */
+struct EnergyModel {
+	double passengerMass = 75.0; // Mass of one passenger, in kg.
+	double counterweightBalance = 0.45; // Fraction of the rated load the counterweight balances.
+	double floorHeight = 3.5; // Height of a floor, in m.
+	double driveEfficiency = 0.75; // Fraction of the energy drawn that the drive turns into lifting work.
+	double regenEfficiency = 0.6; // Fraction of the overhauling work returned to the mains, 0 without a regenerative drive.
+	double lossPerFloor = 0.002; // Friction and drive losses of moving one floor whatever the load, in kWh.
+	double startStopEnergy = 0.004; // Energy of accelerating from rest and braking to rest, in kWh.
+	double standbyPower = 0.15; // Power drawn by an idle car for lights, ventilation and the controller, in kW.
+
+	/**
+	 * @brief Checks the model.
+	 *
+	 * @throw std::invalid_argument if a mass, height, energy or power is negative, the balance or the
+	 * regeneration efficiency is not between 0 and 1, or the drive efficiency is not above 0 and at most 1.
+	 */
+	void validate() const {
+		if (passengerMass < 0 || floorHeight < 0 || lossPerFloor < 0 || startStopEnergy < 0 || standbyPower < 0) {
+			throw std::invalid_argument("Masses, heights, energies and powers cannot be negative");
+		}
+		if (counterweightBalance < 0 || counterweightBalance > 1 || regenEfficiency < 0 || regenEfficiency > 1
+			|| driveEfficiency <= 0 || driveEfficiency > 1) {
+			throw std::invalid_argument("Counterweight balance and efficiencies must be fractions");
+		}
+	}
+
+	/**
+	 * @brief Gets the lifting work of a run, positive if the drive supplies it and negative if the run overhauls.
+	 *
+	 * @param floors The number of floors moved.
+	 * @param direction The direction of the run.
+	 * @param load The number of passengers in the car.
+	 * @param ratedLoad The capacity of the car.
+	 * @return The work in kWh.
+	 */
+	double liftingWork(int floors, ElevatorDirection direction, int load, int ratedLoad) const {
+		const double imbalance = (load - counterweightBalance * ratedLoad) * passengerMass;
+		const double work = imbalance * GRAVITY * floorHeight * floors / JOULES_PER_KWH;
+		return direction == ElevatorDirection::UP ? work : -work;
+	}
+
+	/**
+	 * @brief Charges a run to a car.
+	 *
+	 * @param energy The energy of the car.
+	 * @param floors The number of floors moved.
+	 * @param direction The direction of the run.
+	 * @param load The number of passengers in the car.
+	 * @param ratedLoad The capacity of the car.
+	 * @param fromRest True if the car starts the run standing.
+	 */
+	void chargeRun(CarEnergy& energy, int floors, ElevatorDirection direction, int load, int ratedLoad, bool fromRest) const {
+		const double work = liftingWork(floors, direction, load, ratedLoad);
+		energy.motoring += floors * lossPerFloor + (work > 0 ? work / driveEfficiency : 0.0);
+		energy.regenerated += work < 0 ? -work * regenEfficiency : 0.0;
+		energy.startStop += fromRest ? startStopEnergy : 0.0;
+	}
+
+	/**
+	 * @brief Gets the net energy of a run.
+	 *
+	 * @param floors The number of floors moved.
+	 * @param direction The direction of the run.
+	 * @param load The number of passengers in the car.
+	 * @param ratedLoad The capacity of the car.
+	 * @param fromRest True if the car starts the run standing.
+	 * @return The energy in kWh, negative if the run returns more than it draws.
+	 */
+	double runEnergy(int floors, ElevatorDirection direction, int load, int ratedLoad, bool fromRest) const {
+		CarEnergy energy;
+		chargeRun(energy, floors, direction, load, ratedLoad, fromRest);
+		return energy.total();
+	}
+
+	/**
+	 * @brief Gets the energy an idle car draws over a time.
+	 *
+	 * @param seconds The time standing idle.
+	 * @return The energy in kWh.
+	 */
+	double standbyEnergy(int seconds) const {
+		return standbyPower * seconds / 3600.0;
+	}
+
+private:
+	static constexpr double GRAVITY = 9.81; // Acceleration of gravity, in m/s^2.
+	static constexpr double JOULES_PER_KWH = 3.6e6; // Joules in a kWh.
+};
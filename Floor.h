@@ -5,6 +5,11 @@
  * The Floor class represents a floor in a building.
  * It manages waiting and delivered passengers on the floor.
  *
+ * The waiting passengers are kept in arrival order in an intrusive list over a pool of records, like the
+ * riders of a car (see RiderBuckets.h), with running counts per direction. A passenger can leave the queue
+ * from anywhere in it in constant time through their record, and the generation of a record tells whether
+ * a reference taken to it earlier still names the same passenger.
+ *
  * @date 4/20/2024
  * @version 1.0
  * @author Jerry Wang
@@ -12,8 +17,14 @@
 
 #pragma once
 #include "Passenger.h"
-#include <queue>
+#include "ElevatorState.h"
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
 #include <memory>
+#include <memory_resource>
 
 class Floor {
 public:
@@ -21,21 +32,124 @@ public:
 	 * @brief Constructs a Floor object with the specified floor number.
 	 *
 	 * @param floorNumber The floor number of the floor.
-	 * @throw std::invalid_argument if floor number is negative or greater than 100.
+	 * @param resource The memory resource used by the passenger queues.
+	 * @throw std::invalid_argument if floor number is negative.
 	 */
-	Floor(int floorNumber) : floorNumber(floorNumber) {
-		if (floorNumber < 0 || floorNumber > 100) {
+	Floor(int floorNumber, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: floorNumber(floorNumber), waiting(resource), deliveredPassengers(resource) {
+		if (floorNumber < 0) {
 			throw std::invalid_argument("Floor number must be non-negative");
 		}
 	}
 
 	/**
-	 * @brief Adds a waiting passenger to the floor.
+	 * @brief Adds a waiting passenger to the end of the queue of the floor.
 	 *
 	 * @param passenger The passenger to be added to the floor.
+	 * @return The record of the passenger in the queue, valid until they leave it.
+	 */
+	int addWaitingPassenger(const Passenger& passenger) {
+		int record = acquireRecord(passenger);
+		waiting[record].prev = waitingTail;
+		if (waitingTail == NONE) {
+			waitingHead = record;
+		}
+		else {
+			waiting[waitingTail].next = record;
+		}
+		waitingTail = record;
+		waitingCount(passenger.getDirection()) += static_cast<size_t>(passenger.getGroupSize());
+		return record;
+	}
+
+	/**
+	 * @brief Removes a waiting passenger from the queue of the floor.
+	 *
+	 * @param record The record of the passenger, see addWaitingPassenger.
+	 * @return The record after it in the queue, or NONE.
+	 */
+	int removeWaitingPassenger(int record) {
+		const Passenger& passenger = waiting[record].passenger;
+		waitingCount(passenger.getDirection()) -= static_cast<size_t>(passenger.getGroupSize());
+
+		int prev = waiting[record].prev;
+		int next = waiting[record].next;
+		if (prev == NONE) {
+			waitingHead = next;
+		}
+		else {
+			waiting[prev].next = next;
+		}
+		if (next == NONE) {
+			waitingTail = prev;
+		}
+		else {
+			waiting[next].prev = prev;
+		}
+		releaseRecord(record);
+		return next;
+	}
+
+	/**
+	 * @brief Takes members off a waiting group who board without the rest of it, which keeps its place in the queue.
+	 *
+	 * @param record The record of the group.
+	 * @param members The number of members leaving, less than the group size.
+	 */
+	void removeWaitingMembers(int record, int members) {
+		Passenger& group = waiting[record].passenger;
+		group.setGroupSize(group.getGroupSize() - members);
+		waitingCount(group.getDirection()) -= static_cast<size_t>(members);
+	}
+
+	/**
+	 * @brief Gets the first record in the queue of the floor.
+	 *
+	 * @return The record of the passenger who has waited longest, or NONE if nobody is waiting.
+	 */
+	int firstWaiting() const {
+		return waitingHead;
+	}
+
+	/**
+	 * @brief Gets the record after another one in the queue of the floor.
+	 *
+	 * @param record A record in the queue.
+	 * @return The next record, or NONE.
+	 */
+	int nextWaiting(int record) const {
+		return waiting[record].next;
+	}
+
+	/**
+	 * @brief Gets the passenger of a record in the queue of the floor.
+	 *
+	 * @param record A record in the queue.
+	 * @return The waiting passenger or group.
+	 */
+	const Passenger& getWaitingPassenger(int record) const {
+		return waiting[record].passenger;
+	}
+
+	/**
+	 * @brief Gets the generation of a record, which changes every time the record leaves the queue.
+	 *
+	 * @param record The record.
+	 * @return The generation.
+	 */
+	std::uint32_t getGeneration(int record) const {
+		return waiting[record].generation;
+	}
+
+	/**
+	 * @brief Checks if a record taken at the given generation is still in the queue.
+	 *
+	 * @param record The record.
+	 * @param generation The generation of the record when it was taken.
+	 * @return True if the passenger of the record is still waiting, false otherwise.
 	 */
-	void addWaitingPassenger(Passenger& passenger) {
-		waitingPassengers.push_back(passenger);
+	bool isWaiting(int record, std::uint32_t generation) const {
+		return record >= 0 && static_cast<size_t>(record) < waiting.size() && waiting[record].generation == generation;
 	}
 
 	/**
@@ -48,21 +162,25 @@ public:
 	}
 
 	/**
-	 * @brief Gets the queue of waiting passengers on the floor.
+	 * @brief Gets the queue of delivered passengers on the floor.
 	 *
-	 * @return A reference to the deque of waiting passengers.
+	 * @return A reference to the deque of delivered passengers.
 	 */
-	std::deque<Passenger>& getWaitingPassengers() {
-		return waitingPassengers;
+	std::pmr::deque<Passenger>& getDeliveredPassengers() {
+		return deliveredPassengers;
 	}
 
 	/**
-	 * @brief Gets the queue of delivered passengers on the floor.
+	 * @brief Reuses an empty floor object for another floor number, keeping the memory of its queues.
 	 *
-	 * @return A reference to the deque of delivered passengers.
+	 * @param floorNumber The new floor number.
+	 * @throw std::logic_error if the floor still has waiting or delivered passengers.
 	 */
-	std::deque<Passenger>& getDeliveredPassengers() {
-		return deliveredPassengers;
+	void reassign(int floorNumber) {
+		if (hasWaitingPassengers() || !deliveredPassengers.empty()) {
+			throw std::logic_error("Only an empty floor can be reassigned");
+		}
+		this->floorNumber = floorNumber;
 	}
 
 	/**
@@ -71,11 +189,80 @@ public:
 	 * @return true if there are waiting passengers, false otherwise.
 	 */
 	bool hasWaitingPassengers() const {
-		return !waitingPassengers.empty();
+		return waitingHead != NONE;
+	}
+
+	/**
+	 * @brief Gets the number of waiting passengers on the floor, counting every member of a group.
+	 *
+	 * @return The number of waiting passengers.
+	 */
+	size_t getWaitingCount() const {
+		return waitingUp + waitingDown;
 	}
 
+	/**
+	 * @brief Gets the number of passengers on the floor waiting to travel in the given direction, counting every member of a group.
+	 *
+	 * @param direction The direction of travel.
+	 * @return The number of waiting passengers.
+	 */
+	size_t getWaitingCount(ElevatorDirection direction) const {
+		return direction == ElevatorDirection::UP ? waitingUp : waitingDown;
+	}
+
+	static constexpr int NONE = -1; // Marks the end of the waiting queue.
+
 private:
+	/**
+	 * @brief Storage for one waiting passenger and its links in the queue.
+	 */
+	struct WaitingRecord {
+		Passenger passenger; // The waiting passenger or group.
+		int prev; // Previous record in arrival order.
+		int next; // Next record in arrival order, or the next unused record.
+		std::uint32_t generation; // Bumped every time the record leaves the queue, so stale references can tell.
+	};
+
 	int floorNumber; // The floor number of the floor.
-	std::deque<Passenger> waitingPassengers; // The deque of waiting passengers on the floor.
-	std::deque<Passenger> deliveredPassengers; // The deque of delivered passengers on the floor.
+	std::pmr::vector<WaitingRecord> waiting; // Waiting passenger storage, reused through the free list.
+	int waitingHead = NONE; // The record of the passenger who has waited longest.
+	int waitingTail = NONE; // The record of the passenger who arrived last.
+	int freeHead = NONE; // The first unused record, linked through next.
+	size_t waitingUp = 0; // The number of people waiting to go up.
+	size_t waitingDown = 0; // The number of people waiting to go down.
+	std::pmr::deque<Passenger> deliveredPassengers; // The deque of delivered passengers on the floor.
+
+	size_t& waitingCount(ElevatorDirection direction) {
+		return direction == ElevatorDirection::UP ? waitingUp : waitingDown;
+	}
+
+	/**
+	 * @brief Stores a waiting passenger in an unused record, growing the storage if none is free.
+	 *
+	 * @param passenger The passenger to store.
+	 * @return The index of the record.
+	 */
+	int acquireRecord(const Passenger& passenger) {
+		if (freeHead == NONE) {
+			waiting.push_back(WaitingRecord{ passenger, NONE, NONE, 0 });
+			return static_cast<int>(waiting.size()) - 1;
+		}
+
+		int record = freeHead;
+		freeHead = waiting[record].next;
+		waiting[record] = WaitingRecord{ passenger, NONE, NONE, waiting[record].generation };
+		return record;
+	}
+
+	/**
+	 * @brief Returns a record to the free list and makes references to it stale.
+	 *
+	 * @param record The index of the record.
+	 */
+	void releaseRecord(int record) {
+		++waiting[record].generation;
+		waiting[record].next = freeHead;
+		freeHead = record;
+	}
 };
@@ -0,0 +1,576 @@
+/**
+ * @file FloorSet.h
+ * @brief Declaration and implementation of the FloorSet class.
+ *
+ * The FloorSet class holds the floors of a building. Only floors with waiting or retained passengers
+ * have a Floor object; idle floors cost a few bits in the hall call bitmaps and one slot index.
+ * Floor objects are pooled and reused when a floor becomes idle, so the memory and time spent on floors
+ * follow the number of busy floors rather than the height of the building.
+ *
+ * In a mixed fleet, where not every car serves every floor, each hall call also carries the set of the
+ * cars that can carry someone waiting for it (see CarMask.h), so a policy checks whether a car may answer a call with one
+ * bit test. While every car serves every floor the masks are not kept and every car may answer every call.
+ * Otherwise the floors served by the same cars form a class, and every busy floor counts its waiting records
+ * per direction and class of destination, so a passenger leaving the queue only rebuilds the cars of a call
+ * when the last record of their class goes, from the counts rather than the queue.
+ *
+ * Each waiting passenger has a handle into the queue of their floor (see Floor.h). Giving up through it
+ * takes constant time, and a handle left over from a passenger who already boarded is recognized as stale.
+ */
+
+#pragma once
+#include "Floor.h"
+#include "Passenger.h"
+#include "ElevatorState.h"
+#include "CarMask.h"
+#include <memory_resource>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+class FloorSet {
+public:
+	/**
+	 * @brief Names a waiting passenger, e.g. to take them off the floor when they give up. Once they leave
+	 * the queue by any way, the handle goes stale and names nobody.
+	 */
+	struct WaitingHandle {
+		int slot = -1; // The slot of the Floor object of the passenger's floor.
+		int record = -1; // The record of the passenger in the queue of the floor.
+		std::uint32_t generation = 0; // The generation of the record when the passenger joined.
+	};
+
+	/**
+	 * @brief Constructs a FloorSet with every floor idle.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param resource The memory resource used for the bitmaps and the Floor objects.
+	 * @throw std::invalid_argument if numOfFloors is less than 1.
+	 */
+	FloorSet(int numOfFloors, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: numOfFloors(checkFloorCount(numOfFloors)), resource(resource), upCalls(wordCount(numOfFloors), 0, resource),
+		downCalls(wordCount(numOfFloors), 0, resource), carsServing(resource), upCallCars(resource), downCallCars(resource),
+		slotOf(numOfFloors + 1, NONE, resource), slots(resource), freeSlots(resource), servedClass(resource), classFloor(resource),
+		classCounts(resource) {
+	}
+
+	/**
+	 * @brief Gets the number of floors in the building.
+	 *
+	 * @return The number of floors.
+	 */
+	int size() const {
+		return numOfFloors;
+	}
+
+	/**
+	 * @brief Sets which cars serve each floor, so hall calls are answered only by cars that can carry the passengers.
+	 *
+	 * Call it before any passenger arrives.
+	 *
+	 * @param masks The set of the cars serving each floor, at row floor number, see ElevatorBank::getServedFloorMasks.
+	 * @throw std::invalid_argument if there is not one row per floor and floor 0.
+	 */
+	void setServedFloorMasks(const CarMasks& masks) {
+		if (masks.getNumOfRows() != numOfFloors + 1) {
+			throw std::invalid_argument("The served-floor masks need one entry per floor and floor 0");
+		}
+		carsServing = masks;
+		upCallCars.reset(masks.getNumOfRows(), masks.getNumOfCars(), false);
+		downCallCars.reset(masks.getNumOfRows(), masks.getNumOfCars(), false);
+
+		// floors served by the same cars share a class, so the calls of a floor are counted per class of destination
+		servedClass.assign(masks.getNumOfRows(), 0);
+		classFloor.clear();
+		for (int floorNumber = 1; floorNumber <= numOfFloors; ++floorNumber) {
+			auto match = std::find_if(classFloor.begin(), classFloor.end(), [&](int other) {
+				return carsServing.equals(floorNumber, other);
+				});
+			servedClass[floorNumber] = static_cast<int>(match - classFloor.begin());
+			if (match == classFloor.end()) {
+				classFloor.push_back(floorNumber);
+			}
+		}
+		classCounts.assign(slots.size() * 2 * classFloor.size(), 0);
+	}
+
+	/**
+	 * @brief Adds a passenger to the waiting queue of their start floor.
+	 *
+	 * @param passenger The arriving passenger.
+	 * @return True if this creates a new hall call, i.e. nobody on the floor was waiting to go the same way.
+	 * @throw std::out_of_range if the start or end floor is not in the building.
+	 */
+	bool addWaitingPassenger(const Passenger& passenger) {
+		WaitingHandle handle;
+		return addWaitingPassenger(passenger, handle);
+	}
+
+	/**
+	 * @brief Adds a passenger to the waiting queue of their start floor and names them for abandon.
+	 *
+	 * @param passenger The arriving passenger.
+	 * @param handle Set to the handle of the passenger.
+	 * @return True if this creates a new hall call, i.e. nobody on the floor was waiting to go the same way.
+	 * @throw std::out_of_range if the start or end floor is not in the building.
+	 */
+	bool addWaitingPassenger(const Passenger& passenger, WaitingHandle& handle) {
+		int floorNumber = passenger.getStartFloor();
+		checkFloor(passenger.getEndFloor());
+		Floor& floor = getFloor(floorNumber);
+		handle.slot = slotOf[floorNumber];
+		handle.record = floor.addWaitingPassenger(passenger);
+		handle.generation = floor.getGeneration(handle.record);
+
+		auto& calls = passenger.getDirection() == ElevatorDirection::UP ? upCalls : downCalls;
+		bool newCall = !testBit(calls, floorNumber);
+		setBit(calls, floorNumber);
+		if (!carsServing.empty() && classCount(handle.slot, passenger)++ == 0) {
+			callCars(passenger.getDirection()).addBoth(floorNumber, carsServing, floorNumber, passenger.getEndFloor());
+		}
+		waitingCount += static_cast<size_t>(passenger.getGroupSize());
+		return newCall;
+	}
+
+	/**
+	 * @brief Checks if a passenger on the floor is waiting to travel in the given direction.
+	 *
+	 * @param floorNumber The floor to check.
+	 * @param direction The direction of travel.
+	 * @return True if there is a hall call in that direction, false otherwise.
+	 */
+	bool hasHallCall(int floorNumber, ElevatorDirection direction) const {
+		return testBit(direction == ElevatorDirection::UP ? upCalls : downCalls, floorNumber);
+	}
+
+	/**
+	 * @brief Gets the cars that can carry someone waiting on a floor to go in the given direction.
+	 *
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return The set of such cars, every car if every car serves every floor.
+	 */
+	CarMask getHallCallCars(int floorNumber, ElevatorDirection direction) const {
+		if (carsServing.empty()) {
+			return CarMask();
+		}
+		return (direction == ElevatorDirection::UP ? upCallCars : downCallCars)[floorNumber];
+	}
+
+	/**
+	 * @brief Checks if a car can carry someone waiting on a floor to go in the given direction.
+	 *
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @param car The index of the elevator.
+	 * @return True if the car may answer the call, false otherwise.
+	 */
+	bool canAnswer(int floorNumber, ElevatorDirection direction, int car) const {
+		return getHallCallCars(floorNumber, direction).contains(car);
+	}
+
+	/**
+	 * @brief Checks if there are waiting passengers on the floor.
+	 *
+	 * @param floorNumber The floor to check.
+	 * @return True if there are waiting passengers, false otherwise.
+	 */
+	bool hasWaitingPassengers(int floorNumber) const {
+		return testBit(upCalls, floorNumber) || testBit(downCalls, floorNumber);
+	}
+
+	/**
+	 * @brief Finds the nearest floor above the given floor where someone is waiting.
+	 *
+	 * @param floorNumber The floor to look above.
+	 * @return The floor number of the hall call, or 0 if nobody is waiting above.
+	 */
+	int findHallCallAbove(int floorNumber) const {
+		size_t word = static_cast<size_t>(floorNumber + 1) >> 6;
+		if (word >= upCalls.size()) {
+			return 0;
+		}
+
+		// mask off the floors at or below floorNumber in the first word, then scan whole words
+		std::uint64_t bits = (upCalls[word] | downCalls[word]) & (~std::uint64_t{ 0 } << ((floorNumber + 1) & 63));
+		while (bits == 0) {
+			if (++word >= upCalls.size()) {
+				return 0;
+			}
+			bits = upCalls[word] | downCalls[word];
+		}
+		return static_cast<int>(word * 64 + lowestBit(bits));
+	}
+
+	/**
+	 * @brief Finds the nearest floor below the given floor where someone is waiting.
+	 *
+	 * @param floorNumber The floor to look below.
+	 * @return The floor number of the hall call, or 0 if nobody is waiting below.
+	 */
+	int findHallCallBelow(int floorNumber) const {
+		if (floorNumber <= 1) {
+			return 0;
+		}
+
+		// mask off the floors at or above floorNumber in the last word, then scan whole words down
+		size_t word = static_cast<size_t>(floorNumber) >> 6;
+		std::uint64_t bits = (upCalls[word] | downCalls[word]) & ((std::uint64_t{ 1 } << (floorNumber & 63)) - 1);
+		while (bits == 0) {
+			if (word-- == 0) {
+				return 0;
+			}
+			bits = upCalls[word] | downCalls[word];
+		}
+		return static_cast<int>(word * 64 + highestBit(bits));
+	}
+
+	/**
+	 * @brief Checks if anyone is waiting on a floor above the given floor.
+	 *
+	 * @param floorNumber The floor to look above.
+	 * @return True if there is a hall call above the floor, false otherwise.
+	 */
+	bool hasHallCallAbove(int floorNumber) const {
+		return findHallCallAbove(floorNumber) != 0;
+	}
+
+	/**
+	 * @brief Checks if anyone is waiting on a floor below the given floor.
+	 *
+	 * @param floorNumber The floor to look below.
+	 * @return True if there is a hall call below the floor, false otherwise.
+	 */
+	bool hasHallCallBelow(int floorNumber) const {
+		return findHallCallBelow(floorNumber) != 0;
+	}
+
+	/**
+	 * @brief Checks if there are waiting passengers anywhere in the building.
+	 *
+	 * @return True if there are waiting passengers, false otherwise.
+	 */
+	bool hasWaitingPassengers() const {
+		return waitingCount != 0;
+	}
+
+	/**
+	 * @brief Gets the number of passengers waiting in the building.
+	 *
+	 * @return The number of waiting passengers.
+	 */
+	size_t getWaitingCount() const {
+		return waitingCount;
+	}
+
+	/**
+	 * @brief Gets the number of passengers waiting on a floor.
+	 *
+	 * @param floorNumber The floor number.
+	 * @return The number of waiting passengers, 0 for an idle floor.
+	 * @throw std::out_of_range if the floor is not in the building.
+	 */
+	size_t getWaitingCount(int floorNumber) const {
+		checkFloor(floorNumber);
+		return slotOf[floorNumber] == NONE ? 0 : slots[slotOf[floorNumber]].getWaitingCount();
+	}
+
+	/**
+	 * @brief Checks if a passenger is still waiting.
+	 *
+	 * @param handle The handle of the passenger, see addWaitingPassenger.
+	 * @return True if the passenger has not boarded or given up since joining the queue, false otherwise.
+	 */
+	bool isWaiting(const WaitingHandle& handle) const {
+		return handle.slot >= 0 && static_cast<size_t>(handle.slot) < slots.size()
+			&& slots[handle.slot].isWaiting(handle.record, handle.generation);
+	}
+
+	/**
+	 * @brief Gets the number of floors that currently have a Floor object.
+	 *
+	 * @return The number of active floors.
+	 */
+	size_t getActiveFloorCount() const {
+		return slots.size() - freeSlots.size();
+	}
+
+	/**
+	 * @brief Gets a floor, activating it if it is idle.
+	 *
+	 * @param floorNumber The floor number.
+	 * @return A reference to the floor. It stays valid while the floor is active.
+	 * @throw std::out_of_range if the floor is not in the building.
+	 */
+	Floor& getFloor(int floorNumber) {
+		checkFloor(floorNumber);
+		if (slotOf[floorNumber] == NONE) {
+			activate(floorNumber);
+		}
+		return slots[slotOf[floorNumber]];
+	}
+
+	/**
+	 * @brief Removes waiting passengers going in the given direction from a floor, in arrival order.
+	 *
+	 * The visitor is called for each boarding passenger before it leaves the queue.
+	 * The floor goes back to idle once nobody is left on it. A group that does not fit boards in part.
+	 *
+	 * @param floorNumber The floor where passengers board.
+	 * @param direction The direction of travel of the elevator.
+	 * @param maxCount The largest number of passengers that may board, counting every member of a group.
+	 * @param visit A callable taking a Passenger reference for each boarding passenger.
+	 */
+	template <typename Visitor>
+	void board(int floorNumber, ElevatorDirection direction, size_t maxCount, Visitor visit) {
+		board(floorNumber, direction, maxCount, [](const Passenger& passenger) { return static_cast<size_t>(passenger.getGroupSize()); }, visit);
+	}
+
+	/**
+	 * @brief Removes the waiting passengers going in the given direction that may board, in arrival order.
+	 *
+	 * The share callable tells how many members of each record may board, e.g. only the part of a group a
+	 * dispatcher gave to this car; records with a share of 0 keep their place in the queue. A share that fits
+	 * boards, as a record of its own if it is only part of the group. A share that does not fit and is larger
+	 * than splitAbove boards as many of its members as fit; a smaller one keeps its place whole, and the
+	 * passengers behind it may still board. The members who do not board wait in the group's place.
+	 *
+	 * @param floorNumber The floor where passengers board.
+	 * @param direction The direction of travel of the elevator.
+	 * @param maxCount The largest number of passengers that may board, counting every member of a group.
+	 * @param share A callable taking a const Passenger reference, returning the number of its members who may board.
+	 * @param visit A callable taking a Passenger reference for each boarding passenger or part of a group.
+	 * @param splitAbove The largest share that only boards whole; 0 lets every share split.
+	 */
+	template <typename Share, typename Visitor>
+	void board(int floorNumber, ElevatorDirection direction, size_t maxCount, Share share, Visitor visit, size_t splitAbove = 0) {
+		if (!hasHallCall(floorNumber, direction)) {
+			return;
+		}
+
+		const int slot = slotOf[floorNumber];
+		Floor& floor = slots[slot];
+		size_t boarded = 0;
+		int record = floor.firstWaiting();
+		while (record != Floor::NONE && boarded < maxCount) {
+			const Passenger& passenger = floor.getWaitingPassenger(record);
+			if (passenger.getDirection() != direction) {
+				record = floor.nextWaiting(record);
+				continue;
+			}
+
+			const size_t room = maxCount - boarded;
+			const size_t size = static_cast<size_t>(passenger.getGroupSize());
+			const size_t unit = std::min(size, share(passenger));
+			if (unit == size && size <= room) {
+				Passenger rider = passenger;
+				visit(rider);
+				forgetCall(floorNumber, slot, rider);
+				record = floor.removeWaitingPassenger(record);
+				boarded += size;
+				continue;
+			}
+			if (unit > 0 && (unit <= room || unit > splitAbove)) {
+				// the members who may board and fit board, the rest wait in the group's place
+				const size_t count = std::min(unit, room);
+				Passenger part = passenger;
+				part.setGroupSize(static_cast<int>(count));
+				floor.removeWaitingMembers(record, static_cast<int>(count));
+				visit(part);
+				boarded += count;
+			}
+			record = floor.nextWaiting(record);
+		}
+		waitingCount -= boarded;
+
+		assignBit(direction == ElevatorDirection::UP ? upCalls : downCalls, floorNumber, floor.getWaitingCount(direction) != 0);
+		releaseIfIdle(floorNumber);
+	}
+
+	/**
+	 * @brief Removes a passenger who gave up waiting from their floor, and clears the hall call if nobody is left for it.
+	 *
+	 * A stale handle, of a passenger who has boarded or given up already, is ignored without touching the queue.
+	 *
+	 * @param handle The handle of the passenger, see addWaitingPassenger.
+	 * @param visit A callable taking a const Passenger reference, called for the passenger before it leaves the queue.
+	 * @return True if the passenger was waiting, false if the handle is stale.
+	 */
+	template <typename Visitor>
+	bool abandon(const WaitingHandle& handle, Visitor visit) {
+		if (!isWaiting(handle)) {
+			return false;
+		}
+
+		Floor& floor = slots[handle.slot];
+		const int floorNumber = floor.getFloorNumber();
+		const Passenger passenger = floor.getWaitingPassenger(handle.record);
+		visit(passenger);
+		waitingCount -= static_cast<size_t>(passenger.getGroupSize());
+		forgetCall(floorNumber, handle.slot, passenger);
+		floor.removeWaitingPassenger(handle.record);
+
+		ElevatorDirection direction = passenger.getDirection();
+		assignBit(direction == ElevatorDirection::UP ? upCalls : downCalls, floorNumber, floor.getWaitingCount(direction) != 0);
+		releaseIfIdle(floorNumber);
+		return true;
+	}
+
+private:
+	static constexpr int NONE = -1; // Marks an idle floor.
+
+	int numOfFloors; // The number of floors in the building.
+	std::pmr::memory_resource* resource; // The memory resource for new Floor objects.
+	std::pmr::vector<std::uint64_t> upCalls; // Bit per floor: someone is waiting to go up.
+	std::pmr::vector<std::uint64_t> downCalls; // Bit per floor: someone is waiting to go down.
+	CarMasks carsServing; // The set of the cars serving each floor, empty while every car serves every floor.
+	CarMasks upCallCars; // The set per floor of the cars that can carry someone waiting to go up.
+	CarMasks downCallCars; // The set per floor of the cars that can carry someone waiting to go down.
+	std::pmr::vector<int> slotOf; // Slot of the Floor object of each floor, or NONE when idle.
+	std::pmr::deque<Floor> slots; // Pool of Floor objects, stable under growth.
+	std::pmr::vector<int> freeSlots; // Slots of floors that went idle.
+	size_t waitingCount = 0; // The number of waiting passengers.
+	std::pmr::vector<int> servedClass; // Class of each floor, shared by the floors served by the same cars. Empty while every car serves every floor.
+	std::pmr::vector<int> classFloor; // A floor of each class.
+	std::pmr::vector<int> classCounts; // Waiting records per Floor slot, direction and class of their destination.
+
+	/**
+	 * @brief Checks that a building has at least one floor.
+	 *
+	 * @param numOfFloors The number of floors.
+	 * @return The number of floors.
+	 * @throw std::invalid_argument if numOfFloors is less than 1.
+	 */
+	static int checkFloorCount(int numOfFloors) {
+		if (numOfFloors < 1) {
+			throw std::invalid_argument("Building must have at least one floor");
+		}
+		return numOfFloors;
+	}
+
+	/**
+	 * @brief Gets the number of 64-bit words needed for one bit per floor, indexed by floor number.
+	 *
+	 * @param numOfFloors The number of floors.
+	 * @return The number of words.
+	 */
+	static size_t wordCount(int numOfFloors) {
+		return static_cast<size_t>(numOfFloors) / 64 + 1;
+	}
+
+	CarMasks& callCars(ElevatorDirection direction) {
+		return direction == ElevatorDirection::UP ? upCallCars : downCallCars;
+	}
+
+	/**
+	 * @brief Gets the number of records waiting on a floor that go the way of a passenger, to a floor served by the same cars.
+	 *
+	 * @param slot The slot of the Floor object of the floor.
+	 * @param passenger The passenger.
+	 * @return A reference to the count.
+	 */
+	int& classCount(int slot, const Passenger& passenger) {
+		const size_t direction = passenger.getDirection() == ElevatorDirection::UP ? 0 : 1;
+		return classCounts[(static_cast<size_t>(slot) * 2 + direction) * classFloor.size() + servedClass[passenger.getEndFloor()]];
+	}
+
+	/**
+	 * @brief Takes a passenger leaving the queue of a floor out of the counts of a mixed fleet, and rebuilds the
+	 * cars of its hall call from the classes still waiting if nobody else went to a floor served by the same cars.
+	 *
+	 * @param floorNumber The floor.
+	 * @param slot The slot of the Floor object of the floor.
+	 * @param passenger The passenger leaving the queue.
+	 */
+	void forgetCall(int floorNumber, int slot, const Passenger& passenger) {
+		if (carsServing.empty() || --classCount(slot, passenger) != 0) {
+			return;
+		}
+
+		const size_t direction = passenger.getDirection() == ElevatorDirection::UP ? 0 : 1;
+		const int* counts = classCounts.data() + (static_cast<size_t>(slot) * 2 + direction) * classFloor.size();
+		CarMasks& cars = callCars(passenger.getDirection());
+		cars.clear(floorNumber);
+		for (size_t group = 0; group < classFloor.size(); ++group) {
+			if (counts[group] != 0) {
+				cars.addBoth(floorNumber, carsServing, floorNumber, classFloor[group]);
+			}
+		}
+	}
+
+	static bool testBit(const std::pmr::vector<std::uint64_t>& bits, int floorNumber) {
+		return (bits[floorNumber >> 6] >> (floorNumber & 63)) & 1u;
+	}
+
+	static int lowestBit(std::uint64_t bits) {
+		int index = 0;
+		while ((bits & 1u) == 0) {
+			bits >>= 1;
+			++index;
+		}
+		return index;
+	}
+
+	static int highestBit(std::uint64_t bits) {
+		int index = 63;
+		while ((bits >> index) == 0) {
+			--index;
+		}
+		return index;
+	}
+
+	static void setBit(std::pmr::vector<std::uint64_t>& bits, int floorNumber) {
+		bits[floorNumber >> 6] |= std::uint64_t{ 1 } << (floorNumber & 63);
+	}
+
+	static void assignBit(std::pmr::vector<std::uint64_t>& bits, int floorNumber, bool value) {
+		std::uint64_t mask = std::uint64_t{ 1 } << (floorNumber & 63);
+		bits[floorNumber >> 6] = (bits[floorNumber >> 6] & ~mask) | (value ? mask : 0);
+	}
+
+	/**
+	 * @brief Checks that a floor number is inside the building.
+	 *
+	 * @param floorNumber The floor number.
+	 * @throw std::out_of_range if the floor is not in the building.
+	 */
+	void checkFloor(int floorNumber) const {
+		if (floorNumber < 1 || floorNumber > numOfFloors) {
+			throw std::out_of_range("Floor " + std::to_string(floorNumber) + " is not in the building");
+		}
+	}
+
+	/**
+	 * @brief Gives an idle floor a Floor object, reusing a free slot if there is one.
+	 *
+	 * @param floorNumber The floor number.
+	 */
+	void activate(int floorNumber) {
+		if (freeSlots.empty()) {
+			slots.emplace_back(floorNumber, resource);
+			slotOf[floorNumber] = static_cast<int>(slots.size()) - 1;
+			classCounts.resize(slots.size() * 2 * classFloor.size(), 0);
+		}
+		else {
+			slotOf[floorNumber] = freeSlots.back();
+			freeSlots.pop_back();
+			slots[slotOf[floorNumber]].reassign(floorNumber);
+		}
+	}
+
+	/**
+	 * @brief Returns the Floor object of a floor to the pool when nobody is waiting or retained there.
+	 *
+	 * @param floorNumber The floor number.
+	 */
+	void releaseIfIdle(int floorNumber) {
+		Floor& floor = slots[slotOf[floorNumber]];
+		if (!floor.hasWaitingPassengers() && floor.getDeliveredPassengers().empty()) {
+			freeSlots.push_back(slotOf[floorNumber]);
+			slotOf[floorNumber] = NONE;
+		}
+	}
+};
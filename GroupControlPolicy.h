@@ -0,0 +1,215 @@
+/**
+ * @file GroupControlPolicy.h
+ * @brief Declaration and implementation of the GroupControlPolicy class.
+ *
+ * The GroupControlPolicy class coordinates all cars of the building as one group. Each new hall call is
+ * assigned to the single car with the lowest estimated time of arrival, and only that car stops for it.
+ * Cars move with LOOK dispatch over their riders and their assigned calls. A call only goes to a car that
+ * can carry someone waiting for it, and is handed on when another car boarded the only passengers its car could carry.
+ *
+ * The estimated times of arrival come from estimateArrivalTimes (see ArrivalTimeEstimate.h), where the
+ * calls already assigned to a car count as stops. With an energy weight set, the energy each car would
+ * spend on the call, from estimateCallEnergies, is added to its time.
+ */
+
+#pragma once
+#include "DispatchPolicy.h"
+#include "Passenger.h"
+#include "ArrivalTimeEstimate.h"
+#include "ElevatorBank.h"
+#include "FloorSet.h"
+#include "ElevatorState.h"
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+class GroupControlPolicy : public LookDispatch<GroupControlPolicy> {
+public:
+	/**
+	 * @brief Checks if a hall call is assigned to the car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @return True if the car is assigned to the call, false otherwise.
+	 */
+	bool answersHallCall(const ElevatorBank& bank, int car, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		return !assignedUp.empty() && assignment(direction)[floorNumber] == car;
+	}
+
+	/**
+	 * @brief Assigns a new hall call to the active car with the lowest estimated time of arrival among the cars that can carry the caller.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the new hall call.
+	 * @param direction The direction of the new hall call.
+	 */
+	void onHallCall(const ElevatorBank& bank, const FloorSet& floors, int floorNumber, ElevatorDirection direction) {
+		assign(bank, floors, floorNumber, direction, NO_CAR);
+	}
+
+	/**
+	 * @brief Updates the assignments at a car's floor after it has boarded.
+	 *
+	 * Calls at the floor that were cleared are released from whichever car held them. A call the car was going
+	 * to serve but could not clear, because it filled up, is handed to the best other car, and so is a call whose car
+	 * can no longer carry anyone waiting for it.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void afterBoarding(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		// a double-deck car boards at the floors of both its decks
+		for (int floorNumber = bank.getCurrentFloor(car); floorNumber <= bank.getUpperDeckFloor(car); ++floorNumber) {
+			for (ElevatorDirection direction : { ElevatorDirection::UP, ElevatorDirection::DOWN }) {
+				int assigned = assignment(direction)[floorNumber];
+				if (assigned == NO_CAR) {
+					continue;
+				}
+
+				if (!floors.hasHallCall(floorNumber, direction)) {
+					release(floorNumber, direction);
+				}
+				else if ((assigned == car && direction == bank.getDirection(car)) || !floors.canAnswer(floorNumber, direction, assigned)) {
+					assign(bank, floors, floorNumber, direction, car);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Releases the call of a passenger who gave up if nobody is left for it, or hands it on if its car can carry none of the rest.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building, without the passenger.
+	 * @param passenger The passenger who left.
+	 */
+	void onAbandon(const ElevatorBank& bank, const FloorSet& floors, const Passenger& passenger) {
+		int floorNumber = passenger.getStartFloor();
+		ElevatorDirection direction = passenger.getDirection();
+		if (assignedUp.empty() || assignment(direction)[floorNumber] == NO_CAR) {
+			return;
+		}
+
+		if (!floors.hasHallCall(floorNumber, direction)) {
+			release(floorNumber, direction);
+		}
+		else if (!floors.canAnswer(floorNumber, direction, assignment(direction)[floorNumber])) {
+			assign(bank, floors, floorNumber, direction, NO_CAR);
+		}
+	}
+
+	/**
+	 * @brief Hands the call a full car is passing by to the best other car.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the elevator.
+	 * @param floors The floors of the building.
+	 */
+	void onFullLoadBypass(const ElevatorBank& bank, int car, const FloorSet& floors) {
+		assign(bank, floors, bank.getCurrentFloor(car), bank.getDirection(car), car);
+	}
+
+	/**
+	 * @brief Gets the number of hall call assignments made, including reassignments.
+	 *
+	 * @return The number of assignments.
+	 */
+	size_t getAssignmentCount() const {
+		return assignmentCount;
+	}
+
+private:
+	static constexpr int NO_CAR = -1; // Marks an unassigned hall call.
+
+	std::vector<int> assignedUp; // Car assigned to the up call of each floor.
+	std::vector<int> assignedDown; // Car assigned to the down call of each floor.
+	std::vector<int> assignedCount; // Number of calls assigned to each car.
+	std::vector<int> cost; // Scratch estimated time of arrival of each car.
+	std::vector<double> energy; // Scratch estimated energy of each car answering the call.
+	size_t assignmentCount = 0; // Number of assignments made.
+
+	/**
+	 * @brief Gets the assignment table for a direction, sized on first use.
+	 *
+	 * @param direction The direction of the hall calls.
+	 * @return The car assigned to each floor's call in that direction.
+	 */
+	std::vector<int>& assignment(ElevatorDirection direction) {
+		return direction == ElevatorDirection::UP ? assignedUp : assignedDown;
+	}
+
+	/**
+	 * @brief Sizes the tables for the bank and the building on first use.
+	 *
+	 * @param bank The elevators of the building.
+	 */
+	void reserve(const ElevatorBank& bank) {
+		if (assignedUp.empty()) {
+			assignedUp.assign(bank.getNumOfFloors() + 1, NO_CAR);
+			assignedDown.assign(bank.getNumOfFloors() + 1, NO_CAR);
+			assignedCount.assign(bank.size(), 0);
+			cost.assign(bank.size(), 0);
+			energy.assign(bank.size(), 0.0);
+		}
+	}
+
+	/**
+	 * @brief Removes the assignment of a hall call.
+	 *
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 */
+	void release(int floorNumber, ElevatorDirection direction) {
+		int& assigned = assignment(direction)[floorNumber];
+		if (assigned != NO_CAR) {
+			--assignedCount[assigned];
+			assigned = NO_CAR;
+		}
+	}
+
+	/**
+	 * @brief Assigns a hall call to the active car with the lowest estimated time of arrival among the cars that can answer it.
+	 *
+	 * If none of them is in service yet, the call goes to the first of them, which picks it up once it starts.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param floors The floors of the building.
+	 * @param floorNumber The floor of the hall call.
+	 * @param direction The direction of the hall call.
+	 * @param excludedCar A car that must not get the call unless it is the only candidate, or NO_CAR.
+	 */
+	void assign(const ElevatorBank& bank, const FloorSet& floors, int floorNumber, ElevatorDirection direction, int excludedCar) {
+		reserve(bank);
+		release(floorNumber, direction);
+		estimateArrivalTimes(bank, floorNumber, direction, assignedCount.data(), cost.data());
+		if (energyWeight > 0) {
+			estimateCallEnergies(bank, floorNumber, assignedCount.data(), energy.data());
+			for (int car = 0; car < bank.getNumOfActiveCars(); ++car) {
+				cost[car] += static_cast<int>(std::lround(energyWeight * energy[car]));
+			}
+		}
+
+		const CarMask candidates = floors.getHallCallCars(floorNumber, direction);
+		int bestCar = NO_CAR;
+		int bestCost = std::numeric_limits<int>::max();
+		for (int car = 0; car < bank.getNumOfActiveCars(); ++car) {
+			if (car != excludedCar && candidates.contains(car) && cost[car] < bestCost) {
+				bestCar = car;
+				bestCost = cost[car];
+			}
+		}
+		if (bestCar == NO_CAR) {
+			bestCar = excludedCar != NO_CAR ? excludedCar : candidates.first();
+		}
+
+		assignment(direction)[floorNumber] = bestCar;
+		++assignedCount[bestCar];
+		++assignmentCount;
+	}
+};
@@ -0,0 +1,182 @@
+/**
+ * @file OfflineSolver.h
+ * @brief Declaration and implementation of the OfflineSolver class.
+ *
+ * The OfflineSolver class gives reference numbers for a passenger trace that is known in advance, to judge
+ * online dispatch policies against:
+ * - lowerBound: a relaxation no policy can beat. Every passenger gets their own car, which must still
+ *   obey the building's kinematics, so a passenger waits at least until the first car could reach their
+ *   floor, and rides at least one floor-to-floor trip at ELEVATOR_SPEED per floor plus one stop.
+ * - solve: an achievable schedule found with complete look-ahead, simulating ClairvoyantPolicy for a range
+ *   of rolling horizons and keeping the best.
+ *
+ * Both run on a pool of threads: the bound over chunks of the trace, the horizons as separate quiet
+ * simulations. The cost is linear in the trace, so day-long traces take seconds.
+ */
+
+#pragma once
+#include "Building.h"
+#include "CarSchedule.h"
+#include "ClairvoyantPolicy.h"
+#include "ParallelFor.h"
+#include "Passenger.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <exception>
+
+class OfflineSolver {
+public:
+	/**
+	 * @brief Mean times per passenger, in seconds.
+	 */
+	struct Means {
+		double wait = 0.0; // Mean wait time.
+		double travel = 0.0; // Mean travel time.
+
+		/**
+		 * @brief Gets the mean time from arrival to delivery.
+		 *
+		 * @return The mean journey time.
+		 */
+		double journey() const {
+			return wait + travel;
+		}
+	};
+
+	/**
+	 * @brief The best achievable schedule found with complete look-ahead.
+	 */
+	struct Solution {
+		int horizon = 0; // The look-ahead horizon of the best run, in seconds.
+		Means means; // Its mean wait and travel time.
+	};
+
+	/**
+	 * @brief Constructs an OfflineSolver for a building and a trace.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param numOfElevators The number of elevators in the building.
+	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+	 * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+	 * @param trace The passengers, in order of arrival. It must outlive the solver.
+	 * @param schedule When each car goes into service and where it starts.
+	 * @param numOfThreads The number of threads, 0 for one per hardware thread.
+	 */
+	OfflineSolver(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+		const std::vector<Passenger>& trace, const CarSchedule& schedule, unsigned numOfThreads = 0)
+		: numOfFloors(numOfFloors), numOfElevators(numOfElevators), elevatorSpeed(elevatorSpeed),
+		elevatorStoppingTime(elevatorStoppingTime), trace(trace), schedule(schedule), numOfThreads(numOfThreads) {
+	}
+
+	/**
+	 * @brief Computes a lower bound on the mean wait and travel time of any policy.
+	 *
+	 * @return The bound. A policy's mean journey time can be compared with Means::journey.
+	 */
+	Means lowerBound() const {
+		if (trace.empty()) {
+			return Means();
+		}
+
+		const size_t chunkSize = 4096;
+		const size_t chunks = (trace.size() + chunkSize - 1) / chunkSize;
+		std::vector<long long> waitSums(chunks, 0);
+		std::vector<long long> travelSums(chunks, 0);
+		std::vector<long long> people(chunks, 0);
+		parallelFor(chunks, numOfThreads, [&](size_t chunk) {
+			size_t end = std::min(trace.size(), (chunk + 1) * chunkSize);
+			for (size_t i = chunk * chunkSize; i < end; ++i) {
+				const Passenger& passenger = trace[i];
+				// every member of a group waits and travels as long as the group
+				const int size = passenger.getGroupSize();
+				waitSums[chunk] += size * std::max(0, earliestBoarding(passenger.getStartFloor()) - passenger.getStartTime());
+				travelSums[chunk] += size * tripTime(passenger.getStartFloor(), passenger.getEndFloor());
+				people[chunk] += size;
+			}
+			});
+
+		Means bound;
+		long long total = 0;
+		for (size_t chunk = 0; chunk < chunks; ++chunk) {
+			bound.wait += waitSums[chunk];
+			bound.travel += travelSums[chunk];
+			total += people[chunk];
+		}
+		bound.wait /= total;
+		bound.travel /= total;
+		return bound;
+	}
+
+	/**
+	 * @brief Simulates the clairvoyant policy with each horizon in parallel and keeps the lowest mean journey time.
+	 *
+	 * @param horizons The look-ahead horizons to try, in seconds.
+	 * @return The best run. Its means are infinite if every run failed.
+	 */
+	Solution solve(const std::vector<int>& horizons = { 0, 30, 60, 120, 300, 600 }) const {
+		std::vector<Solution> runs(horizons.size());
+		parallelFor(horizons.size(), numOfThreads, [&](size_t i) {
+			runs[i].horizon = horizons[i];
+			runs[i].means.wait = std::numeric_limits<double>::infinity();
+			try {
+				Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "offline", trace, true);
+				building.setCarSchedule(schedule);
+				ClairvoyantPolicy policy(trace, horizons[i]);
+				building.simulate(policy);
+				runs[i].means.wait = building.getWaitTimeStat().getAverage();
+				runs[i].means.travel = building.getTravelTimeStat().getAverage();
+			}
+			catch (const std::exception&) {
+				// leave the run infinite so it is never chosen
+			}
+			});
+
+		Solution best;
+		best.means.wait = std::numeric_limits<double>::infinity();
+		for (const Solution& run : runs) {
+			if (run.means.journey() < best.means.journey()) {
+				best = run;
+			}
+		}
+		return best;
+	}
+
+private:
+	const int numOfFloors; // The number of floors in the building.
+	const int numOfElevators; // The number of elevators in the building.
+	const int elevatorSpeed; // The speed of the elevators (in seconds per floor).
+	const int elevatorStoppingTime; // The time taken for the elevator to stop at a floor (in seconds).
+	const std::vector<Passenger>& trace; // The passengers, in order of arrival.
+	const CarSchedule schedule; // When each car goes into service and where it starts.
+	const unsigned numOfThreads; // The number of threads.
+
+	/**
+	 * @brief Gets the time from a car leaving a floor to it boarding or unloading at another floor.
+	 *
+	 * A car moves a floor every ELEVATOR_SPEED seconds and then needs ELEVATOR_STOPPING_TIME seconds to stop.
+	 *
+	 * @param from The floor the car leaves.
+	 * @param to The floor the car stops at.
+	 * @return The time in seconds, 0 if the floors are the same.
+	 */
+	int tripTime(int from, int to) const {
+		return from == to ? 0 : std::abs(to - from) * elevatorSpeed + elevatorStoppingTime;
+	}
+
+	/**
+	 * @brief Gets the earliest time any car could board a passenger on a floor.
+	 *
+	 * @param floorNumber The floor.
+	 * @return The time in seconds.
+	 */
+	int earliestBoarding(int floorNumber) const {
+		int earliest = std::numeric_limits<int>::max();
+		for (int car = 0; car < numOfElevators; ++car) {
+			int startFloor = schedule.getParkingFloor(car) == CarSchedule::NO_PARKING ? 1 : schedule.getParkingFloor(car);
+			earliest = std::min(earliest, schedule.getStartTime(car) + tripTime(startFloor, floorNumber));
+		}
+		return earliest;
+	}
+};
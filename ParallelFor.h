@@ -0,0 +1,47 @@
+/**
+ * @file ParallelFor.h
+ * @brief Runs independent jobs on a pool of threads.
+ *
+ * Used by the optimizers to simulate many candidate configurations at once. Each job is one whole
+ * simulation, so the threads pull job indices from a shared counter and never touch each other's data.
+ */
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief Calls a job for every index from 0 to count - 1, spread over up to numOfThreads threads.
+ *
+ * The calling thread runs jobs too. The job must not throw.
+ *
+ * @param count The number of jobs.
+ * @param numOfThreads The largest number of threads, 0 for one per hardware thread.
+ * @param job A callable taking the size_t index of a job.
+ */
+template <typename Job>
+void parallelFor(size_t count, unsigned numOfThreads, Job job) {
+	if (numOfThreads == 0) {
+		numOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::atomic<size_t> next{ 0 };
+	auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			job(i);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	size_t threads = std::min<size_t>(numOfThreads, count);
+	for (size_t t = 1; t < threads; ++t) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+}
@@ -0,0 +1,457 @@
+/**
+ * @file ParameterTuner.h
+ * @brief Declaration and implementation of the ParameterTuner class.
+ *
+ * The ParameterTuner class tunes the start time and parking floor of every car, the car capacity and the
+ * stopping (dwell) time of a building for a passenger trace, with a genetic algorithm. Each generation's
+ * new candidates are simulated in parallel in quiet Buildings sharing one loaded trace.
+ *
+ * Cars are interchangeable, so a configuration is normalized by sorting the cars by start time before it
+ * is simulated. Results are cached under the normalized configuration, so a configuration met again, in a
+ * later generation or as another ordering of the same cars, is never simulated twice. A run is stopped
+ * early once the passengers it has delivered prove it cannot come within the abort margin of the best
+ * score so far; such a dominated candidate scores infinity.
+ */
+
+#pragma once
+#include "Building.h"
+#include "CarSchedule.h"
+#include "ScheduleOptimizer.h"
+#include "ParallelFor.h"
+#include "Passenger.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <stdexcept>
+#include <exception>
+
+/**
+ * @brief One set of values for the tuned knobs.
+ */
+struct TuningConfig {
+	std::vector<int> startTimes; // The time in seconds each car goes into service, in any order.
+	std::vector<int> parkingFloors; // The parking floor of each car, or CarSchedule::NO_PARKING.
+	int capacity = 8; // The maximum number of passengers in a car.
+	int stopTime = 2; // The time a car takes to stop at a floor, in seconds.
+
+	/**
+	 * @brief Sorts the cars by start time, keeping each car's parking floor with it.
+	 *
+	 * @return The same configuration with start times in non-decreasing order.
+	 */
+	TuningConfig normalized() const {
+		std::vector<size_t> order(startTimes.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+			return startTimes[a] < startTimes[b] || (startTimes[a] == startTimes[b] && parkingFloors[a] < parkingFloors[b]);
+			});
+
+		TuningConfig sorted{ {}, {}, capacity, stopTime };
+		for (size_t car : order) {
+			sorted.startTimes.push_back(startTimes[car]);
+			sorted.parkingFloors.push_back(parkingFloors[car]);
+		}
+		return sorted;
+	}
+
+	/**
+	 * @brief Gets the car schedule of the configuration.
+	 *
+	 * @return The schedule, with cars sorted by start time.
+	 */
+	CarSchedule schedule() const {
+		TuningConfig sorted = normalized();
+		return CarSchedule(sorted.startTimes, sorted.parkingFloors);
+	}
+
+	/**
+	 * @brief Gets every value of the normalized configuration in one list, used as the cache key.
+	 *
+	 * @return The values.
+	 */
+	std::vector<int> key() const {
+		TuningConfig sorted = normalized();
+		std::vector<int> values = sorted.startTimes;
+		values.insert(values.end(), sorted.parkingFloors.begin(), sorted.parkingFloors.end());
+		values.push_back(capacity);
+		values.push_back(stopTime);
+		return values;
+	}
+
+	/**
+	 * @brief Formats the configuration as text.
+	 *
+	 * @return The schedule, capacity and stopping time.
+	 */
+	std::string toString() const {
+		return schedule().toString() + "; capacity " + std::to_string(capacity) + "; stop time " + std::to_string(stopTime) + "s";
+	}
+};
+
+/**
+ * @brief The range searched for each knob. A range with equal ends keeps the knob fixed.
+ */
+struct TuningSpace {
+	int maxStartTime = 1000; // Latest start time of a car, in seconds.
+	int startTimeStep = 50; // Start times are multiples of this, in seconds.
+	int minCapacity = 8; // Smallest car capacity.
+	int maxCapacity = 8; // Largest car capacity.
+	int minStopTime = 2; // Shortest stopping time, in seconds.
+	int maxStopTime = 2; // Longest stopping time, in seconds.
+};
+
+/**
+ * @brief The progress of the search after one generation.
+ */
+struct GenerationRecord {
+	int generation; // The generation, from 0.
+	size_t simulations; // Simulations run so far, aborted ones included.
+	size_t cacheHits; // Candidates so far whose score came from the cache.
+	size_t aborted; // Simulations so far stopped early as dominated.
+	double generationBest; // Best score in this generation.
+	double generationMean; // Mean score of the candidates of this generation that were not dominated.
+	double bestScore; // Best score so far.
+};
+
+class ParameterTuner {
+public:
+	/**
+	 * @brief The best configuration found and how the search got there.
+	 */
+	struct Result {
+		TuningConfig config; // The best configuration, normalized.
+		ScheduleOptimizer::Evaluation evaluation; // Its mean and 95th percentile wait.
+		std::vector<GenerationRecord> history; // One record per generation.
+	};
+
+	/**
+	 * @brief Constructs a ParameterTuner for a building and a trace.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param numOfElevators The number of elevators in the building.
+	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+	 * @param trace The passengers to simulate, in order of arrival. It must outlive the tuner.
+	 * @param objective The wait time measure to minimize.
+	 * @param space The range searched for each knob.
+	 * @param seed The seed of the random number generator, so a search can be repeated.
+	 * @param numOfThreads The number of simulations run at once, 0 for one per hardware thread.
+	 * @throw std::invalid_argument if a range in the space is empty or the start time step is not positive.
+	 */
+	ParameterTuner(int numOfFloors, int numOfElevators, int elevatorSpeed, const std::vector<Passenger>& trace,
+		ScheduleObjective objective, TuningSpace space = TuningSpace(), unsigned seed = 1, unsigned numOfThreads = 0)
+		: numOfFloors(numOfFloors), numOfElevators(numOfElevators), elevatorSpeed(elevatorSpeed), trace(trace),
+		objective(objective), space(space), numOfThreads(numOfThreads), random(seed) {
+		if (space.startTimeStep <= 0 || space.maxStartTime < 0 || space.minCapacity < 1 || space.minCapacity > space.maxCapacity
+			|| space.minStopTime < 1 || space.minStopTime > space.maxStopTime) {
+			throw std::invalid_argument("Invalid tuning space");
+		}
+	}
+
+	/**
+	 * @brief Sets the number of candidates per generation.
+	 *
+	 * @param size The population size, at least 2.
+	 */
+	void setPopulationSize(int size) {
+		populationSize = std::max(2, size);
+	}
+
+	/**
+	 * @brief Sets the number of generations.
+	 *
+	 * @param count The number of generations, at least 1.
+	 */
+	void setGenerations(int count) {
+		generations = std::max(1, count);
+	}
+
+	/**
+	 * @brief Sets how much worse than the best score a run may provably get before it is stopped.
+	 *
+	 * @param margin The margin as a fraction of the best score, e.g. 0.25; infinity never stops a run.
+	 */
+	void setAbortMargin(double margin) {
+		abortMargin = margin;
+	}
+
+	/**
+	 * @brief Runs the genetic algorithm.
+	 *
+	 * The first generation holds the initial configuration and random ones. Each later generation keeps the
+	 * two best candidates and fills up with children of tournament-selected parents: uniform crossover, with
+	 * a car's start time and parking floor inherited together, then mutation of each value with probability
+	 * one over the number of values.
+	 *
+	 * @tparam Policy The dispatch policy type, default constructible, see DispatchPolicy.h.
+	 * @param initial The configuration to seed the search with, with one car per elevator.
+	 * @return The best configuration and the convergence history.
+	 * @throw std::invalid_argument if the initial configuration does not have one car per elevator.
+	 */
+	template <typename Policy>
+	Result tune(const TuningConfig& initial) {
+		if (static_cast<int>(initial.startTimes.size()) != numOfElevators || initial.parkingFloors.size() != initial.startTimes.size()) {
+			throw std::invalid_argument("The initial configuration must have one car per elevator");
+		}
+
+		Result result{ initial.normalized(), ScheduleOptimizer::Evaluation(), {} };
+		std::vector<TuningConfig> population{ initial };
+		while (static_cast<int>(population.size()) < populationSize) {
+			population.push_back(randomConfig());
+		}
+
+		for (int generation = 0; generation < generations; ++generation) {
+			std::vector<double> scores = evaluate<Policy>(population, score(result.evaluation) * (1.0 + abortMargin));
+
+			// keep the best candidate and record the generation
+			double generationBest = std::numeric_limits<double>::infinity();
+			double sum = 0.0;
+			int finite = 0;
+			for (size_t i = 0; i < population.size(); ++i) {
+				if (scores[i] < score(result.evaluation)) {
+					result.config = population[i].normalized();
+					result.evaluation = cache[population[i].key()];
+				}
+				generationBest = std::min(generationBest, scores[i]);
+				if (std::isfinite(scores[i])) {
+					sum += scores[i];
+					++finite;
+				}
+			}
+			result.history.push_back(GenerationRecord{ generation, simulations, cacheHits, aborted, generationBest,
+				finite == 0 ? std::numeric_limits<double>::infinity() : sum / finite, score(result.evaluation) });
+
+			if (generation + 1 < generations) {
+				population = breed(population, scores);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Writes a convergence history as CSV with a header line.
+	 *
+	 * @param history The history of a search.
+	 * @param out The stream to write to.
+	 */
+	static void writeHistory(const std::vector<GenerationRecord>& history, std::ostream& out) {
+		out << "generation,simulations,cache_hits,aborted,generation_best,generation_mean,best\n";
+		for (const GenerationRecord& record : history) {
+			out << record.generation << ',' << record.simulations << ',' << record.cacheHits << ',' << record.aborted << ','
+				<< record.generationBest << ',' << record.generationMean << ',' << record.bestScore << '\n';
+		}
+	}
+
+private:
+	static constexpr int ELITES = 2; // Best candidates copied unchanged into the next generation.
+	static constexpr int TOURNAMENT_SIZE = 3; // Candidates compared to select a parent.
+
+	const int numOfFloors; // The number of floors in the building.
+	const int numOfElevators; // The number of elevators in the building.
+	const int elevatorSpeed; // The speed of the elevators (in seconds per floor).
+	const std::vector<Passenger>& trace; // The passengers to simulate.
+	const ScheduleObjective objective; // The wait time measure to minimize.
+	const TuningSpace space; // The range searched for each knob.
+	const unsigned numOfThreads; // The number of simulations run at once.
+	std::mt19937 random; // The random number generator of the search.
+	int populationSize = 16; // Candidates per generation.
+	int generations = 10; // Number of generations.
+	double abortMargin = 0.25; // How much worse than the best a run may provably get before it is stopped.
+
+	std::map<std::vector<int>, ScheduleOptimizer::Evaluation> cache; // Evaluation of every normalized configuration seen.
+	size_t simulations = 0; // Simulations run.
+	size_t cacheHits = 0; // Candidates scored from the cache.
+	size_t aborted = 0; // Simulations stopped early.
+
+	double score(const ScheduleOptimizer::Evaluation& evaluation) const {
+		return objective == ScheduleObjective::MEAN_WAIT ? evaluation.meanWait : evaluation.p95Wait;
+	}
+
+	/**
+	 * @brief Scores a population, simulating in parallel only the configurations not in the cache.
+	 *
+	 * @tparam Policy The dispatch policy type.
+	 * @param population The candidates.
+	 * @param bound Score above which a run is stopped as dominated.
+	 * @return The score of each candidate, infinite for a dominated or failed one.
+	 */
+	template <typename Policy>
+	std::vector<double> evaluate(const std::vector<TuningConfig>& population, double bound) {
+		// collect the configurations never seen before, once each
+		std::vector<std::vector<int>> keys;
+		std::vector<const TuningConfig*> pending;
+		for (const TuningConfig& config : population) {
+			std::vector<int> key = config.key();
+			if (cache.count(key) != 0) {
+				++cacheHits;
+			}
+			else {
+				cache[key] = ScheduleOptimizer::Evaluation();
+				keys.push_back(std::move(key));
+				pending.push_back(&config);
+			}
+		}
+
+		std::vector<ScheduleOptimizer::Evaluation> evaluations(pending.size());
+		std::vector<char> stopped(pending.size(), 0);
+		parallelFor(pending.size(), numOfThreads, [&](size_t i) {
+			stopped[i] = !simulate<Policy>(*pending[i], bound, evaluations[i]);
+			});
+
+		for (size_t i = 0; i < pending.size(); ++i) {
+			cache[keys[i]] = evaluations[i];
+			aborted += stopped[i];
+		}
+		simulations += pending.size();
+
+		std::vector<double> scores;
+		for (const TuningConfig& config : population) {
+			scores.push_back(score(cache[config.key()]));
+		}
+		return scores;
+	}
+
+	/**
+	 * @brief Simulates the trace with one configuration in a quiet building.
+	 *
+	 * @tparam Policy The dispatch policy type.
+	 * @param config The configuration.
+	 * @param bound Score above which the run is stopped as dominated.
+	 * @param evaluation Receives the mean and 95th percentile wait, left infinite if the run was stopped or failed.
+	 * @return False if the run was stopped early, true otherwise.
+	 */
+	template <typename Policy>
+	bool simulate(const TuningConfig& config, double bound, ScheduleOptimizer::Evaluation& evaluation) const {
+		try {
+			Building building(numOfFloors, numOfElevators, elevatorSpeed, config.stopTime, "tuner", trace, true);
+			building.setCarSchedule(config.schedule());
+			building.setCapacity(config.capacity);
+
+			// the waits delivered so far only grow, so once they prove the score exceeds the bound the run is dominated
+			const double total = static_cast<double>(building.getPassengerCount());
+			auto dominated = [&](const Building& running) {
+				const Statistic& waits = running.getWaitTimeStat();
+				if (objective == ScheduleObjective::MEAN_WAIT) {
+					return waits.getSum() > bound * total;
+				}
+				size_t allowedAbove = static_cast<size_t>(total) - static_cast<size_t>(std::ceil(0.95 * total));
+				return std::isfinite(bound) && waits.getCountAbove(static_cast<int>(bound)) > allowedAbove;
+			};
+
+			Policy policy;
+			if (!building.simulate(policy, dominated)) {
+				return false;
+			}
+			evaluation.meanWait = building.getWaitTimeStat().getAverage();
+			evaluation.p95Wait = building.getWaitTimeStat().getPercentile(95);
+		}
+		catch (const std::exception&) {
+			// leave the wait infinite so the configuration is never chosen
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Makes a configuration with every value drawn uniformly from the space.
+	 *
+	 * @return The configuration.
+	 */
+	TuningConfig randomConfig() {
+		TuningConfig config;
+		for (int car = 0; car < numOfElevators; ++car) {
+			config.startTimes.push_back(randomStartTime());
+			config.parkingFloors.push_back(randomParkingFloor());
+		}
+		config.capacity = uniform(space.minCapacity, space.maxCapacity);
+		config.stopTime = uniform(space.minStopTime, space.maxStopTime);
+		return config;
+	}
+
+	/**
+	 * @brief Makes the next generation from the scored current one.
+	 *
+	 * @param population The current candidates.
+	 * @param scores The score of each candidate.
+	 * @return The next candidates.
+	 */
+	std::vector<TuningConfig> breed(const std::vector<TuningConfig>& population, const std::vector<double>& scores) {
+		std::vector<size_t> ranked(population.size());
+		std::iota(ranked.begin(), ranked.end(), 0);
+		std::stable_sort(ranked.begin(), ranked.end(), [&](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+		std::vector<TuningConfig> next;
+		for (int i = 0; i < ELITES && i < static_cast<int>(ranked.size()); ++i) {
+			next.push_back(population[ranked[i]]);
+		}
+
+		const double mutationRate = 1.0 / (2 * numOfElevators + 2);
+		std::uniform_real_distribution<double> chance(0.0, 1.0);
+		while (static_cast<int>(next.size()) < populationSize) {
+			const TuningConfig& mother = population[select(scores)];
+			const TuningConfig& father = population[select(scores)];
+
+			TuningConfig child = mother;
+			for (int car = 0; car < numOfElevators; ++car) {
+				if (chance(random) < 0.5) {
+					child.startTimes[car] = father.startTimes[car];
+					child.parkingFloors[car] = father.parkingFloors[car];
+				}
+				if (chance(random) < mutationRate) {
+					int shift = space.startTimeStep * uniform(-3, 3);
+					child.startTimes[car] = std::clamp(child.startTimes[car] + shift, 0, space.maxStartTime);
+				}
+				if (chance(random) < mutationRate) {
+					child.parkingFloors[car] = randomParkingFloor();
+				}
+			}
+			if (chance(random) < 0.5) {
+				child.capacity = father.capacity;
+			}
+			if (chance(random) < 0.5) {
+				child.stopTime = father.stopTime;
+			}
+			if (chance(random) < mutationRate) {
+				child.capacity = std::clamp(child.capacity + uniform(-1, 1), space.minCapacity, space.maxCapacity);
+			}
+			if (chance(random) < mutationRate) {
+				child.stopTime = std::clamp(child.stopTime + uniform(-1, 1), space.minStopTime, space.maxStopTime);
+			}
+			next.push_back(child);
+		}
+		return next;
+	}
+
+	/**
+	 * @brief Picks a parent by tournament: the best of a few candidates drawn at random.
+	 *
+	 * @param scores The score of each candidate.
+	 * @return The index of the parent.
+	 */
+	size_t select(const std::vector<double>& scores) {
+		size_t best = static_cast<size_t>(uniform(0, static_cast<int>(scores.size()) - 1));
+		for (int i = 1; i < TOURNAMENT_SIZE; ++i) {
+			size_t other = static_cast<size_t>(uniform(0, static_cast<int>(scores.size()) - 1));
+			if (scores[other] < scores[best]) {
+				best = other;
+			}
+		}
+		return best;
+	}
+
+	int uniform(int low, int high) {
+		return std::uniform_int_distribution<int>(low, high)(random);
+	}
+
+	int randomStartTime() {
+		return space.startTimeStep * uniform(0, space.maxStartTime / space.startTimeStep);
+	}
+
+	int randomParkingFloor() {
+		return uniform(CarSchedule::NO_PARKING, numOfFloors);
+	}
+};
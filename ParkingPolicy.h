@@ -0,0 +1,369 @@
+/**
+ * @file ParkingPolicy.h
+ * @brief Declaration and implementation of the parking policies and the parking events.
+ *
+ * A ParkingPolicy picks the floor a car waits at once it runs out of work. With a parking policy set on the
+ * Building, a car with nothing to do asks for a floor, runs there and goes IDLE; it gives the floor up as
+ * soon as it boards someone or leaves its parking floor for a call, and asks again the next time it runs
+ * out of work. Without one, cars keep the fixed parking floors of their CarSchedule.
+ *
+ * - LobbyParking sends every car back to the main lobby.
+ * - SpreadParking splits the building into one zone per car in service and parks each car at the centre
+ *   of the nearest zone no other car is parked at or heading for.
+ * - PredictiveParking parks each car at the floor with the most hall calls in a sliding window of recent
+ *   demand that no other car has taken. The window is a DemandHistogram, which counts calls per floor and
+ *   updates in O(1) amortized time per call.
+ * - TrafficModeParking switches between them with the traffic mode (see TrafficMode.h): lobby parking in
+ *   up-peak, spread parking in inter-floor traffic, and predictive parking otherwise.
+ *
+ * Every decision is reported to the ParkingSinks of the Building as a ParkingEvent. ParkingTally adds them up.
+ */
+
+#pragma once
+#include "ElevatorBank.h"
+#include "TrafficMode.h"
+#include <vector>
+#include <deque>
+#include <cstdlib>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief One parking decision for a car that ran out of work.
+ */
+struct ParkingEvent {
+	int car = 0; // The index of the car.
+	int time = 0; // The time of the decision, in seconds.
+	int fromFloor = 0; // The floor where the car ran out of work.
+	int toFloor = 0; // The parking floor chosen.
+};
+
+class ParkingSink {
+public:
+	virtual ~ParkingSink() = default;
+
+	/**
+	 * @brief Receives a parking decision.
+	 *
+	 * @param event The decision.
+	 */
+	virtual void record(const ParkingEvent& event) = 0;
+};
+
+/**
+ * @brief Counts parking decisions and the floors cars run to park.
+ */
+class ParkingTally : public ParkingSink {
+public:
+	void record(const ParkingEvent& event) override {
+		++decisionCount;
+		parkingRunCount += event.fromFloor != event.toFloor;
+		floorsRun += std::abs(event.toFloor - event.fromFloor);
+	}
+
+	/**
+	 * @brief Gets the number of parking decisions.
+	 *
+	 * @return The number of decisions.
+	 */
+	size_t getDecisionCount() const {
+		return decisionCount;
+	}
+
+	/**
+	 * @brief Gets the number of decisions that sent a car to another floor.
+	 *
+	 * @return The number of parking runs.
+	 */
+	size_t getParkingRunCount() const {
+		return parkingRunCount;
+	}
+
+	/**
+	 * @brief Gets the number of floors cars ran to reach their parking floors.
+	 *
+	 * @return The number of floors.
+	 */
+	long long getFloorsRun() const {
+		return floorsRun;
+	}
+
+private:
+	size_t decisionCount = 0; // The number of decisions.
+	size_t parkingRunCount = 0; // The number of decisions that moved a car.
+	long long floorsRun = 0; // The floors run to parking floors.
+};
+
+/**
+ * @brief Counts of hall calls per floor over a sliding window of time.
+ *
+ * Calls are kept in arrival order, so expiring the oldest ones is a pop from the front and a decrement.
+ */
+class DemandHistogram {
+public:
+	/**
+	 * @brief Constructs an empty histogram.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param window The length of the window in seconds.
+	 * @throw std::invalid_argument if the window is less than 1 second.
+	 */
+	DemandHistogram(int numOfFloors, int window)
+		: window(window), counts(numOfFloors + 1, 0) {
+		if (window < 1) {
+			throw std::invalid_argument("The demand window must be at least 1 second");
+		}
+	}
+
+	/**
+	 * @brief Counts a hall call and drops the calls that left the window.
+	 *
+	 * @param floorNumber The floor of the call.
+	 * @param currentTime The time of the call, not earlier than the previous one.
+	 */
+	void record(int floorNumber, int currentTime) {
+		expire(currentTime);
+		calls.push_back({ currentTime, floorNumber });
+		++counts[floorNumber];
+	}
+
+	/**
+	 * @brief Drops the calls older than the window.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void expire(int currentTime) {
+		while (!calls.empty() && calls.front().time <= currentTime - window) {
+			--counts[calls.front().floorNumber];
+			calls.pop_front();
+		}
+	}
+
+	/**
+	 * @brief Gets the number of calls at a floor in the window.
+	 *
+	 * @param floorNumber The floor.
+	 * @return The number of calls.
+	 */
+	int getCount(int floorNumber) const {
+		return counts[floorNumber];
+	}
+
+	/**
+	 * @brief Gets the number of calls in the window.
+	 *
+	 * @return The number of calls.
+	 */
+	size_t getTotal() const {
+		return calls.size();
+	}
+
+private:
+	struct Call {
+		int time; // The time of the call.
+		int floorNumber; // The floor of the call.
+	};
+
+	int window; // The length of the window in seconds.
+	std::vector<int> counts; // The number of calls in the window per floor.
+	std::deque<Call> calls; // The calls in the window, oldest first.
+};
+
+class ParkingPolicy {
+public:
+	virtual ~ParkingPolicy() = default;
+
+	/**
+	 * @brief Chooses the floor an idle car parks at.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the car that ran out of work.
+	 * @param currentTime The current simulation time in seconds.
+	 * @return A floor the car serves.
+	 */
+	virtual int chooseParkingFloor(const ElevatorBank& bank, int car, int currentTime) = 0;
+
+	/**
+	 * @brief Receives a passenger's hall call, for policies that learn where demand comes from.
+	 *
+	 * @param floorNumber The floor of the call.
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	virtual void recordCall(int floorNumber, int currentTime) {}
+
+	/**
+	 * @brief Receives a change of the traffic mode, for policies that switch strategy with it.
+	 *
+	 * @param mode The new traffic mode.
+	 */
+	virtual void onTrafficModeChange(TrafficMode mode) {}
+
+protected:
+	/**
+	 * @brief Checks if another car in service is parked at or heading for a floor.
+	 *
+	 * @param bank The elevators of the building.
+	 * @param car The index of the car choosing.
+	 * @param floorNumber The floor.
+	 * @return True if the floor is taken, false otherwise.
+	 */
+	static bool isTaken(const ElevatorBank& bank, int car, int floorNumber) {
+		for (int other = 0; other < bank.getNumOfActiveCars(); ++other) {
+			if (other != car && bank.getParkingFloor(other) == floorNumber) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+/**
+ * @brief Parks every car at the main lobby, or at the car's nearest served floor if it does not serve the lobby.
+ */
+class LobbyParking : public ParkingPolicy {
+public:
+	/**
+	 * @brief Constructs the policy.
+	 *
+	 * @param lobbyFloor The floor of the main lobby.
+	 */
+	explicit LobbyParking(int lobbyFloor = 1)
+		: lobbyFloor(lobbyFloor) {
+	}
+
+	int chooseParkingFloor(const ElevatorBank& bank, int car, int currentTime) override {
+		int best = bank.getCurrentFloor(car);
+		for (int floorNumber = 1; floorNumber <= bank.getNumOfFloors(); ++floorNumber) {
+			if (bank.serves(car, floorNumber) && std::abs(floorNumber - lobbyFloor) < std::abs(best - lobbyFloor)) {
+				best = floorNumber;
+			}
+		}
+		return best;
+	}
+
+private:
+	int lobbyFloor; // The floor of the main lobby.
+};
+
+/**
+ * @brief Parks the cars at the centres of equal zones, one zone per car in service, the nearest free zone first.
+ */
+class SpreadParking : public ParkingPolicy {
+public:
+	int chooseParkingFloor(const ElevatorBank& bank, int car, int currentTime) override {
+		const int zones = bank.getNumOfActiveCars();
+		const int here = bank.getCurrentFloor(car);
+		int best = 0;
+		bool bestTaken = true;
+		for (int zone = 0; zone < zones; ++zone) {
+			const int centre = 1 + (2 * zone + 1) * (bank.getNumOfFloors() - 1) / (2 * zones);
+			if (!bank.serves(car, centre)) {
+				continue;
+			}
+
+			// prefer a free zone, then the nearest one
+			const bool taken = isTaken(bank, car, centre);
+			if (best == 0 || (bestTaken && !taken) || (taken == bestTaken && std::abs(centre - here) < std::abs(best - here))) {
+				best = centre;
+				bestTaken = taken;
+			}
+		}
+		return best == 0 ? here : best;
+	}
+};
+
+/**
+ * @brief Parks each car at the busiest floor of the recent demand that no other car has taken, the nearest one on a tie.
+ *
+ * With no demand in the window the car stays where it is.
+ */
+class PredictiveParking : public ParkingPolicy {
+public:
+	/**
+	 * @brief Constructs the policy.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param window The length of the demand window in seconds.
+	 * @throw std::invalid_argument if the window is less than 1 second.
+	 */
+	PredictiveParking(int numOfFloors, int window = 300)
+		: demand(numOfFloors, window) {
+	}
+
+	int chooseParkingFloor(const ElevatorBank& bank, int car, int currentTime) override {
+		demand.expire(currentTime);
+		const int here = bank.getCurrentFloor(car);
+		int best = here;
+		int bestCount = 0;
+		for (int floorNumber = 1; floorNumber <= bank.getNumOfFloors(); ++floorNumber) {
+			const int count = demand.getCount(floorNumber);
+			if (count == 0 || !bank.serves(car, floorNumber) || isTaken(bank, car, floorNumber)) {
+				continue;
+			}
+			if (count > bestCount || (count == bestCount && std::abs(floorNumber - here) < std::abs(best - here))) {
+				best = floorNumber;
+				bestCount = count;
+			}
+		}
+		return best;
+	}
+
+	void recordCall(int floorNumber, int currentTime) override {
+		demand.record(floorNumber, currentTime);
+	}
+
+	/**
+	 * @brief Gets the recent demand.
+	 *
+	 * @return The calls per floor in the window.
+	 */
+	const DemandHistogram& getDemand() const {
+		return demand;
+	}
+
+private:
+	DemandHistogram demand; // The hall calls per floor in the window.
+};
+
+/**
+ * @brief Parks at the lobby in up-peak, spreads the cars in inter-floor traffic, and follows recent demand otherwise.
+ */
+class TrafficModeParking : public ParkingPolicy {
+public:
+	/**
+	 * @brief Constructs the policy, in inter-floor mode.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param lobbyFloor The floor of the main lobby.
+	 * @param window The length of the demand window of predictive parking in seconds.
+	 * @throw std::invalid_argument if the window is less than 1 second.
+	 */
+	TrafficModeParking(int numOfFloors, int lobbyFloor = 1, int window = 300)
+		: lobby(lobbyFloor), predictive(numOfFloors, window) {
+	}
+
+	int chooseParkingFloor(const ElevatorBank& bank, int car, int currentTime) override {
+		switch (mode) {
+		case TrafficMode::UP_PEAK:
+			return lobby.chooseParkingFloor(bank, car, currentTime);
+		case TrafficMode::INTER_FLOOR:
+			return spread.chooseParkingFloor(bank, car, currentTime);
+		default:
+			return predictive.chooseParkingFloor(bank, car, currentTime);
+		}
+	}
+
+	void recordCall(int floorNumber, int currentTime) override {
+		predictive.recordCall(floorNumber, currentTime);
+	}
+
+	void onTrafficModeChange(TrafficMode mode) override {
+		this->mode = mode;
+	}
+
+private:
+	TrafficMode mode = TrafficMode::INTER_FLOOR; // The current traffic mode.
+	LobbyParking lobby; // The strategy for up-peak.
+	SpreadParking spread; // The strategy for inter-floor traffic.
+	PredictiveParking predictive; // The strategy for down-peak and two-way traffic.
+};
@@ -1,21 +1,44 @@
 /**
  * @file Passenger.h
- * @brief Declaration of the Passenger class.
+ * @brief Declaration of the BasicPassenger class template and the Passenger alias.
  *
  * The Passenger class represents a passenger in the building.
  * It manages information about the passenger, including their ID, start time, start and end floors, direction,
  * waiting time, and travel time.
  *
+ * Passengers are stored in a packed record whose field widths are chosen at compile time. With the default
+ * widths (16-bit floors and durations, 32-bit IDs and times) a passenger takes 16 bytes, so four fit in a
+ * cache line. The direction is not stored; it is derived from the start and end floors. Floor numbers
+ * are only limited by FloorT, so the default record supports buildings of up to 65535 floors. Wait and
+ * travel times saturate at the largest DurationT, about 18 hours by default, so a very long wait is
+ * reported as that rather than stopping the simulation.
+ *
+ * A record can stand for a group of people travelling together, e.g. leaving a meeting for the same floor.
+ * The group size shares the start time field: its top 8 bits hold the size, up to 255, and the rest the
+ * start time, so the default record allows start times up to 16777215 seconds, about 194 days. Every
+ * count of people, from car loads to the statistics, weighs a record by its group size, while queues and
+ * cars hold one record per group.
+ *
  * @date 4/20/2024
- * @version 1.0
+ * @version 1.1
  * @author Jerry Wang
  */
 
 #pragma once
 #include <stdexcept>
+#include <cstdint>
+#include <limits>
 #include "ElevatorState.h"
 
-class Passenger {
+/**
+ * @brief A packed passenger record.
+ *
+ * @tparam FloorT The unsigned integer type used to store floor numbers.
+ * @tparam TimeT The unsigned integer type used to store the passenger ID and the arrival time.
+ * @tparam DurationT The unsigned integer type used to store the wait and travel times.
+ */
+template <typename FloorT, typename TimeT, typename DurationT>
+class BasicPassenger {
 public:
 	/**
 	 * @brief Constructs a Passenger object with the specified parameters.
@@ -24,25 +47,21 @@ public:
 	 * @param startTime The time at which the passenger arrives.
 	 * @param startFloor The floor from which the passenger starts.
 	 * @param endFloor The floor to which the passenger wants to go.
-	 * @throw std::invalid_argument if the startFloor or endFloor is invalid.
+	 * @param groupSize The number of people travelling together in the record.
+	 * @throw std::invalid_argument if the startFloor or endFloor is below 1 or does not fit in FloorT, or the group size is not between 1 and MAX_GROUP_SIZE.
+	 * @throw std::out_of_range if the passengerID does not fit in TimeT or the startTime does not fit in the start time bits.
 	 */
-	Passenger(int passengerID, int startTime, int startFloor, int endFloor)
-		: passengerID(passengerID), startTime(startTime), waitTime(0), travelTime(0) {
+	BasicPassenger(int passengerID, int startTime, int startFloor, int endFloor, int groupSize = 1)
+		: passengerID(narrow<TimeT>(passengerID, "Passenger ID out of range")),
+		startTime(narrow<TimeT>(startTime, "Start time out of range", MAX_START_TIME)), groupSize(1), waitTime(0), travelTime(0) {
+		setGroupSize(groupSize);
 		// make sure the floor numbers are valid
-		if (startFloor < 1 || startFloor > 100 || endFloor < 1 || endFloor > 100) {
+		if (startFloor < 1 || !fits<FloorT>(startFloor) || endFloor < 1 || !fits<FloorT>(endFloor)) {
 			throw std::invalid_argument("Invalid floor number");
 		}
 		else {
-			this->startFloor = startFloor;
-			this->endFloor = endFloor;
-		}
-
-		// set the direction of the passenger
-		if (startFloor < endFloor) {
-			this->direction = ElevatorDirection::UP;
-		}
-		else {
-			this->direction = ElevatorDirection::DOWN;
+			this->startFloor = static_cast<FloorT>(startFloor);
+			this->endFloor = static_cast<FloorT>(endFloor);
 		}
 	}
 
@@ -65,7 +84,7 @@ public:
 	 *
 	 * @return The direction of travel.
 	 */
-	ElevatorDirection getDirection() const { return direction; }
+	ElevatorDirection getDirection() const { return startFloor < endFloor ? ElevatorDirection::UP : ElevatorDirection::DOWN; }
 
 	/**
 	 * @brief Gets the starting floor of the passenger.
@@ -86,35 +105,112 @@ public:
 	 *
 	 * @return The start time in seconds.
 	 */
-	int getStartTime() const { return startTime; }
+	int getStartTime() const { return static_cast<int>(startTime); }
 
 	/**
 	 * @brief Gets the unique identifier of the passenger.
 	 *
 	 * @return The passenger ID.
 	 */
-	int getPassengerID() const { return passengerID; }
+	int getPassengerID() const { return static_cast<int>(passengerID); }
+
+	/**
+	 * @brief Gets the number of people travelling together in the record.
+	 *
+	 * @return The group size, 1 for a single passenger.
+	 */
+	int getGroupSize() const { return static_cast<int>(groupSize); }
+
+	/**
+	 * @brief Sets the number of people in the record, e.g. when part of a group boards and the rest waits.
+	 *
+	 * @param size The group size.
+	 * @throw std::invalid_argument if the size is not between 1 and MAX_GROUP_SIZE.
+	 */
+	void setGroupSize(int size) {
+		if (size < 1 || size > MAX_GROUP_SIZE) {
+			throw std::invalid_argument("Group size out of range");
+		}
+		groupSize = static_cast<TimeT>(size);
+	}
 
 	/**
 	 * @brief Calculates the waiting time of the passenger.
 	 *
 	 * @param currentTime The current time in seconds.
 	 */
-	void calculateWaitTime(int currentTime) { waitTime = currentTime - startTime; }
+	void calculateWaitTime(int currentTime) { waitTime = toDuration(currentTime - getStartTime()); }
 
 	/**
 	 * @brief Calculates the travel time of the passenger.
 	 *
 	 * @param currentTime The current time in seconds.
 	 */
-	void calculateTravelTime(int currentTime) { travelTime = currentTime - (startTime + waitTime); }
+	void calculateTravelTime(int currentTime) { travelTime = toDuration(currentTime - (getStartTime() + getWaitTime())); }
+
+	static constexpr int GROUP_BITS = 8; // Bits of the start time field holding the group size.
+	static constexpr int MAX_GROUP_SIZE = (1 << GROUP_BITS) - 1; // The largest group a record can hold.
+	static_assert(std::numeric_limits<TimeT>::digits > GROUP_BITS, "TimeT must leave bits for the start time next to the group size");
+	static constexpr unsigned long long MAX_START_TIME = (~0ull) >> (64 - std::numeric_limits<TimeT>::digits + GROUP_BITS); // The latest start time.
 
 private:
-	int passengerID; // The unique identifier for the passenger.
-	int startTime; // The time at which the passenger arrives.
-	int startFloor; // The floor from which the passenger starts.
-	int endFloor; // The floor to which the passenger wants to go.
-	ElevatorDirection direction; // The direction in which the passenger wants to travel.
-	int waitTime; // The amout of time passenger waits for elevator.
-	int travelTime; // The travel time of the passenger. Time when passenger gets on elevator - time when passenger arrives at destination
+	TimeT passengerID; // The unique identifier for the passenger.
+	TimeT startTime : std::numeric_limits<TimeT>::digits - GROUP_BITS; // The time at which the passenger arrives.
+	TimeT groupSize : GROUP_BITS; // The number of people travelling together.
+	FloorT startFloor; // The floor from which the passenger starts.
+	FloorT endFloor; // The floor to which the passenger wants to go.
+	DurationT waitTime; // The amout of time passenger waits for elevator.
+	DurationT travelTime; // The travel time of the passenger. Time when passenger gets on elevator - time when passenger arrives at destination
+
+	/**
+	 * @brief Checks if an int can be stored in a narrower unsigned field type.
+	 *
+	 * @param value The value to check.
+	 * @param max The largest value the field holds, the maximum of T unless the field is a bit-field.
+	 * @return True if the value is non-negative and not larger than the maximum.
+	 */
+	template <typename T>
+	static bool fits(int value, unsigned long long max = std::numeric_limits<T>::max()) {
+		return value >= 0 && static_cast<unsigned long long>(value) <= max;
+	}
+
+	/**
+	 * @brief Converts a non-negative int to a narrower unsigned field type.
+	 *
+	 * @param value The value to convert.
+	 * @param message The message of the exception thrown when the value does not fit.
+	 * @param max The largest value the field holds, the maximum of T unless the field is a bit-field.
+	 * @return The converted value.
+	 * @throw std::out_of_range if the value is negative or too large.
+	 */
+	template <typename T>
+	static T narrow(int value, const char* message, unsigned long long max = std::numeric_limits<T>::max()) {
+		if (!fits<T>(value, max)) {
+			throw std::out_of_range(message);
+		}
+		return static_cast<T>(value);
+	}
+
+	/**
+	 * @brief Converts an elapsed time to DurationT, saturating at the ends of its range.
+	 *
+	 * @param value The elapsed time in seconds.
+	 * @return The converted value, 0 for a negative time and the maximum of DurationT for one too large.
+	 */
+	static DurationT toDuration(int value) {
+		if (value < 0) {
+			return 0;
+		}
+		if (static_cast<unsigned long long>(value) > std::numeric_limits<DurationT>::max()) {
+			return std::numeric_limits<DurationT>::max();
+		}
+		return static_cast<DurationT>(value);
+	}
 };
+
+/**
+ * @brief The passenger record used by the simulation: 16-bit floors and durations, 32-bit IDs and times.
+ */
+using Passenger = BasicPassenger<std::uint16_t, std::uint32_t, std::uint16_t>;
+
+static_assert(sizeof(Passenger) == 16, "Passenger should stay a 16-byte record");
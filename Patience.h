@@ -0,0 +1,64 @@
+/**
+ * @file Patience.h
+ * @brief Declaration and implementation of the passenger patience model.
+ *
+ * A PatienceModel says how long passengers are willing to wait for a car before they give up and take the
+ * stairs, and how long a queue puts them off joining at all. Patience is drawn per passenger from a Weibull
+ * distribution with the given mean: a shape of 1 gives exponential patience, where the chance of leaving
+ * does not depend on the time waited so far, and larger shapes make passengers leave increasingly often as
+ * their wait grows. A passenger who arrives at a queue of balkingQueueLength or more balks and does not join.
+ */
+
+#pragma once
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+struct PatienceModel {
+	double meanPatience = 180.0; // Mean time a passenger waits before leaving, in seconds.
+	double shape = 2.0; // Shape of the Weibull distribution of patience, 1 for exponential.
+	int balkingQueueLength = 0; // Queue length on the floor at which arriving passengers balk, 0 never to balk.
+	unsigned seed = 1; // Seed of the random patience draws, so runs can be repeated.
+
+	/**
+	 * @brief Checks the model.
+	 *
+	 * @throw std::invalid_argument if the mean or the shape is not positive, or the queue length is negative.
+	 */
+	void validate() const {
+		if (meanPatience <= 0 || shape <= 0 || balkingQueueLength < 0) {
+			throw std::invalid_argument("Patience must have a positive mean and shape, and the balking queue length cannot be negative");
+		}
+	}
+
+	/**
+	 * @brief Gets the Weibull distribution of patience with the mean and shape of the model.
+	 *
+	 * @return The distribution, in seconds.
+	 */
+	std::weibull_distribution<double> distribution() const {
+		return std::weibull_distribution<double>(shape, meanPatience / std::tgamma(1.0 + 1.0 / shape));
+	}
+
+	/**
+	 * @brief Draws the patience of one passenger.
+	 *
+	 * @param random The random number generator.
+	 * @param patience The distribution from distribution().
+	 * @return The patience in whole seconds, at least 1.
+	 */
+	static int draw(std::mt19937& random, std::weibull_distribution<double>& patience) {
+		return std::max(1, static_cast<int>(std::lround(patience(random))));
+	}
+
+	/**
+	 * @brief Checks if a passenger arriving at a queue balks.
+	 *
+	 * @param queueLength The number of passengers already waiting on the floor.
+	 * @return True if the passenger does not join the queue, false otherwise.
+	 */
+	bool balks(size_t queueLength) const {
+		return balkingQueueLength > 0 && queueLength >= static_cast<size_t>(balkingQueueLength);
+	}
+};
@@ -0,0 +1,287 @@
+/**
+ * @file RiderBuckets.h
+ * @brief Declaration and implementation of the RiderBuckets class.
+ *
+ * The RiderBuckets class holds the passengers riding inside an elevator, grouped by destination floor.
+ * Every rider is linked into an intrusive list for its destination floor and into a boarding-order list,
+ * so unloading at a floor only touches the riders getting off while iteration still follows boarding order.
+ *
+ * Riders are bucketed by the stop where they get off rather than by their destination. In a single-deck
+ * car the two are the same; in a double-deck car an upper-deck rider gets off at the stop one floor below
+ * their destination, where their deck is level with it, so both decks unload in one pass over one bucket.
+ */
+
+#pragma once
+#include "Passenger.h"
+#include <vector>
+#include <memory_resource>
+#include <cstddef>
+
+class RiderBuckets {
+public:
+	/**
+	 * @brief Constructs an empty RiderBuckets object.
+	 *
+	 * @param numOfFloors The number of floors in the building, used to size the per-floor lists.
+	 * @param resource The memory resource used by the rider storage and the per-floor lists.
+	 */
+	explicit RiderBuckets(int numOfFloors, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: slots(resource), floorHead(numOfFloors + 1, NONE, resource), floorTail(numOfFloors + 1, NONE, resource) {
+	}
+
+	/**
+	 * @brief Checks if there are no riders.
+	 *
+	 * @return True if nobody is riding, false otherwise.
+	 */
+	bool empty() const {
+		return count == 0;
+	}
+
+	/**
+	 * @brief Gets the number of riders.
+	 *
+	 * @return The number of riders, a group counting once.
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @brief Gets the number of people riding.
+	 *
+	 * @return The number of people, counting every member of a group.
+	 */
+	size_t getHeadcount() const {
+		return headcount;
+	}
+
+	/**
+	 * @brief Checks if any rider gets off at the given stop.
+	 *
+	 * @param floorNumber The floor of the stop.
+	 * @return True if at least one rider gets off there, false otherwise.
+	 */
+	bool hasRidersFor(int floorNumber) const {
+		return floorHead[floorNumber] != NONE;
+	}
+
+	/**
+	 * @brief Checks if any rider gets off at a stop above the given floor.
+	 *
+	 * @param floorNumber The floor to compare with.
+	 * @return True if at least one rider gets off higher up, false otherwise.
+	 */
+	bool hasRidersAbove(int floorNumber) const {
+		for (int slot = boardedHead; slot != NONE; slot = slots[slot].nextBoarded) {
+			if (slots[slot].stop > floorNumber) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Checks if any rider gets off at a stop below the given floor.
+	 *
+	 * @param floorNumber The floor to compare with.
+	 * @return True if at least one rider gets off further down, false otherwise.
+	 */
+	bool hasRidersBelow(int floorNumber) const {
+		for (int slot = boardedHead; slot != NONE; slot = slots[slot].nextBoarded) {
+			if (slots[slot].stop < floorNumber) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Finds the nearest stop above the given floor where a rider gets off.
+	 *
+	 * @param floorNumber The floor to look above.
+	 * @return The floor of the stop, or 0 if no rider gets off higher up.
+	 */
+	int findDestinationAbove(int floorNumber) const {
+		int nearest = 0;
+		for (int slot = boardedHead; slot != NONE; slot = slots[slot].nextBoarded) {
+			int endFloor = slots[slot].stop;
+			if (endFloor > floorNumber && (nearest == 0 || endFloor < nearest)) {
+				nearest = endFloor;
+			}
+		}
+		return nearest;
+	}
+
+	/**
+	 * @brief Finds the nearest stop below the given floor where a rider gets off.
+	 *
+	 * @param floorNumber The floor to look below.
+	 * @return The floor of the stop, or 0 if no rider gets off further down.
+	 */
+	int findDestinationBelow(int floorNumber) const {
+		int nearest = 0;
+		for (int slot = boardedHead; slot != NONE; slot = slots[slot].nextBoarded) {
+			int endFloor = slots[slot].stop;
+			if (endFloor < floorNumber && endFloor > nearest) {
+				nearest = endFloor;
+			}
+		}
+		return nearest;
+	}
+
+	/**
+	 * @brief Adds a rider to the end of the boarding order and to the list of its destination floor.
+	 *
+	 * @param passenger The passenger boarding the elevator.
+	 */
+	void push(const Passenger& passenger) {
+		push(passenger, passenger.getEndFloor());
+	}
+
+	/**
+	 * @brief Adds a rider to the end of the boarding order and to the list of the stop where they get off.
+	 *
+	 * @param passenger The passenger boarding the elevator.
+	 * @param floorNumber The floor of the stop, e.g. one below the destination for the upper deck of a double-deck car.
+	 */
+	void push(const Passenger& passenger, int floorNumber) {
+		int slot = acquireSlot(passenger);
+		slots[slot].stop = floorNumber;
+
+		// append to the destination floor list
+		if (floorTail[floorNumber] == NONE) {
+			floorHead[floorNumber] = slot;
+		}
+		else {
+			slots[floorTail[floorNumber]].nextSameFloor = slot;
+		}
+		floorTail[floorNumber] = slot;
+
+		// append to the boarding order list
+		slots[slot].prevBoarded = boardedTail;
+		if (boardedTail == NONE) {
+			boardedHead = slot;
+		}
+		else {
+			slots[boardedTail].nextBoarded = slot;
+		}
+		boardedTail = slot;
+
+		++count;
+		headcount += static_cast<size_t>(passenger.getGroupSize());
+	}
+
+	/**
+	 * @brief Removes every rider getting off at the given stop, in boarding order.
+	 *
+	 * The visitor is called for each rider before it is unlinked, so the rider is still counted
+	 * and iterated while the visitor runs.
+	 *
+	 * @param floorNumber The floor of the stop.
+	 * @param visit A callable taking a Passenger reference for each rider getting off.
+	 */
+	template <typename Visitor>
+	void unload(int floorNumber, Visitor visit) {
+		int slot = floorHead[floorNumber];
+		while (slot != NONE) {
+			visit(slots[slot].rider);
+
+			int next = slots[slot].nextSameFloor;
+			headcount -= static_cast<size_t>(slots[slot].rider.getGroupSize());
+			unlinkBoarded(slot);
+			releaseSlot(slot);
+			--count;
+			slot = next;
+		}
+		floorHead[floorNumber] = NONE;
+		floorTail[floorNumber] = NONE;
+	}
+
+	/**
+	 * @brief Visits every rider in boarding order.
+	 *
+	 * @param visit A callable taking a const Passenger reference.
+	 */
+	template <typename Visitor>
+	void forEach(Visitor visit) const {
+		for (int slot = boardedHead; slot != NONE; slot = slots[slot].nextBoarded) {
+			visit(slots[slot].rider);
+		}
+	}
+
+private:
+	static constexpr int NONE = -1; /**< Marks the end of an intrusive list. */
+
+	/**
+	 * @brief Storage for one rider and its intrusive links.
+	 */
+	struct Slot {
+		Passenger rider; /**< The passenger riding the elevator. */
+		int stop; /**< The floor of the stop where the rider gets off. */
+		int nextSameFloor; /**< Next rider with the same destination floor. */
+		int prevBoarded; /**< Previous rider in boarding order. */
+		int nextBoarded; /**< Next rider in boarding order. */
+	};
+
+	std::pmr::vector<Slot> slots; /**< Rider storage, reused through the free list. */
+	std::pmr::vector<int> floorHead; /**< First rider for each stop floor. */
+	std::pmr::vector<int> floorTail; /**< Last rider for each stop floor. */
+	int boardedHead = NONE; /**< First rider in boarding order. */
+	int boardedTail = NONE; /**< Last rider in boarding order. */
+	int freeHead = NONE; /**< First unused slot, linked through nextBoarded. */
+	size_t count = 0; /**< The number of riders. */
+	size_t headcount = 0; /**< The number of people riding, counting every member of a group. */
+
+	/**
+	 * @brief Stores a rider in an unused slot, growing the storage if none is free.
+	 *
+	 * @param passenger The passenger to store.
+	 * @return The index of the slot.
+	 */
+	int acquireSlot(const Passenger& passenger) {
+		if (freeHead == NONE) {
+			slots.push_back(Slot{ passenger, passenger.getEndFloor(), NONE, NONE, NONE });
+			return static_cast<int>(slots.size()) - 1;
+		}
+
+		int slot = freeHead;
+		freeHead = slots[slot].nextBoarded;
+		slots[slot] = Slot{ passenger, passenger.getEndFloor(), NONE, NONE, NONE };
+		return slot;
+	}
+
+	/**
+	 * @brief Returns a slot to the free list.
+	 *
+	 * @param slot The index of the slot.
+	 */
+	void releaseSlot(int slot) {
+		slots[slot].nextBoarded = freeHead;
+		freeHead = slot;
+	}
+
+	/**
+	 * @brief Removes a slot from the boarding order list.
+	 *
+	 * @param slot The index of the slot.
+	 */
+	void unlinkBoarded(int slot) {
+		int prev = slots[slot].prevBoarded;
+		int next = slots[slot].nextBoarded;
+
+		if (prev == NONE) {
+			boardedHead = next;
+		}
+		else {
+			slots[prev].nextBoarded = next;
+		}
+
+		if (next == NONE) {
+			boardedTail = prev;
+		}
+		else {
+			slots[next].prevBoarded = prev;
+		}
+	}
+};
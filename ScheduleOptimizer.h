@@ -0,0 +1,236 @@
+/**
+ * @file ScheduleOptimizer.h
+ * @brief Declaration and implementation of the ScheduleOptimizer class.
+ *
+ * The ScheduleOptimizer class searches for the car schedule, start times and parking floors, that gives
+ * the lowest mean or 95th percentile wait for a passenger trace. Every candidate schedule is scored by
+ * simulating the whole trace in a quiet Building, and the candidates of a step are simulated in parallel
+ * on a pool of threads sharing one loaded trace.
+ *
+ * The search is coordinate descent over a grid: each round tries, for one car at a time, every start time
+ * on the grid between the start times of its neighbours and every parking floor on the grid, keeps the
+ * best change, and stops after a round without improvement. The simulation is deterministic, so the
+ * result only depends on the trace, the grids and the starting schedule.
+ */
+
+#pragma once
+#include "Building.h"
+#include "CarSchedule.h"
+#include "Passenger.h"
+#include "ParallelFor.h"
+#include <vector>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+
+/**
+ * @brief The wait time measure a schedule search minimizes.
+ */
+enum class ScheduleObjective { MEAN_WAIT, P95_WAIT };
+
+class ScheduleOptimizer {
+public:
+	/**
+	 * @brief The outcome of simulating one schedule.
+	 */
+	struct Evaluation {
+		double meanWait = std::numeric_limits<double>::infinity(); // Mean wait time in seconds.
+		double p95Wait = std::numeric_limits<double>::infinity(); // 95th percentile wait time in seconds.
+	};
+
+	/**
+	 * @brief The best schedule found by a search.
+	 */
+	struct Result {
+		CarSchedule schedule; // The best schedule.
+		Evaluation evaluation; // Its mean and 95th percentile wait.
+		size_t evaluations; // The number of schedules simulated.
+		int rounds; // The number of rounds run.
+	};
+
+	/**
+	 * @brief Constructs a ScheduleOptimizer for a building and a trace.
+	 *
+	 * The default grids try start times from 0 to 1000 seconds in steps of 50, and no parking floor
+	 * or the bottom, quarter points and top of the building.
+	 *
+	 * @param numOfFloors The number of floors in the building.
+	 * @param numOfElevators The number of elevators in the building.
+	 * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+	 * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+	 * @param trace The passengers to simulate, in order of arrival. It must outlive the optimizer.
+	 * @param objective The wait time measure to minimize.
+	 * @param numOfThreads The number of simulations run at once, 0 for one per hardware thread.
+	 */
+	ScheduleOptimizer(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+		const std::vector<Passenger>& trace, ScheduleObjective objective, unsigned numOfThreads = 0)
+		: numOfFloors(numOfFloors), numOfElevators(numOfElevators), elevatorSpeed(elevatorSpeed),
+		elevatorStoppingTime(elevatorStoppingTime), trace(trace), objective(objective),
+		numOfThreads(numOfThreads != 0 ? numOfThreads : std::max(1u, std::thread::hardware_concurrency())) {
+		for (int startTime = 0; startTime <= 1000; startTime += 50) {
+			startTimeGrid.push_back(startTime);
+		}
+		parkingGrid = { CarSchedule::NO_PARKING, 1, std::max(1, numOfFloors / 4), std::max(1, numOfFloors / 2),
+			std::max(1, 3 * numOfFloors / 4), numOfFloors };
+		parkingGrid.erase(std::unique(parkingGrid.begin(), parkingGrid.end()), parkingGrid.end());
+	}
+
+	/**
+	 * @brief Sets the start times tried for each car.
+	 *
+	 * @param startTimes The start times in seconds.
+	 */
+	void setStartTimeGrid(std::vector<int> startTimes) {
+		startTimeGrid = std::move(startTimes);
+	}
+
+	/**
+	 * @brief Sets the parking floors tried for each car.
+	 *
+	 * @param parkingFloors The parking floors, CarSchedule::NO_PARKING included if cars may have none.
+	 */
+	void setParkingGrid(std::vector<int> parkingFloors) {
+		parkingGrid = std::move(parkingFloors);
+	}
+
+	/**
+	 * @brief Searches for the best schedule, starting from the given one.
+	 *
+	 * @tparam Policy The dispatch policy type, default constructible, see DispatchPolicy.h.
+	 * @param initial The schedule to start from, with one entry per elevator.
+	 * @param maxRounds The largest number of rounds over all cars.
+	 * @return The best schedule found.
+	 * @throw std::invalid_argument if the schedule does not have one entry per elevator.
+	 */
+	template <typename Policy>
+	Result optimize(const CarSchedule& initial, int maxRounds = 5) {
+		if (initial.size() != numOfElevators) {
+			throw std::invalid_argument("The car schedule must have one entry per elevator");
+		}
+
+		Result result{ initial, evaluate<Policy>({ initial }).front(), 1, 0 };
+		for (int round = 0; round < maxRounds; ++round) {
+			bool improved = false;
+			for (int car = 0; car < numOfElevators; ++car) {
+				std::vector<CarSchedule> candidates = neighbours(result.schedule, car);
+				std::vector<Evaluation> evaluations = evaluate<Policy>(candidates);
+				result.evaluations += candidates.size();
+
+				for (size_t i = 0; i < candidates.size(); ++i) {
+					if (score(evaluations[i]) < score(result.evaluation)) {
+						result.schedule = candidates[i];
+						result.evaluation = evaluations[i];
+						improved = true;
+					}
+				}
+			}
+			++result.rounds;
+			if (!improved) {
+				break;
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Simulates schedules in parallel.
+	 *
+	 * A schedule whose simulation fails gets an infinite wait.
+	 *
+	 * @tparam Policy The dispatch policy type, default constructible, see DispatchPolicy.h.
+	 * @param schedules The schedules to simulate.
+	 * @return The evaluation of each schedule, in the same order.
+	 */
+	template <typename Policy>
+	std::vector<Evaluation> evaluate(const std::vector<CarSchedule>& schedules) {
+		std::vector<Evaluation> evaluations(schedules.size());
+		parallelFor(schedules.size(), numOfThreads, [&](size_t i) {
+			evaluations[i] = simulate<Policy>(schedules[i]);
+			});
+		return evaluations;
+	}
+
+	/**
+	 * @brief Gets the value of an evaluation under the objective of the optimizer.
+	 *
+	 * @param evaluation The evaluation.
+	 * @return The mean or 95th percentile wait in seconds.
+	 */
+	double score(const Evaluation& evaluation) const {
+		return objective == ScheduleObjective::MEAN_WAIT ? evaluation.meanWait : evaluation.p95Wait;
+	}
+
+private:
+	const int numOfFloors; // The number of floors in the building.
+	const int numOfElevators; // The number of elevators in the building.
+	const int elevatorSpeed; // The speed of the elevators (in seconds per floor).
+	const int elevatorStoppingTime; // The time taken for the elevator to stop at a floor (in seconds).
+	const std::vector<Passenger>& trace; // The passengers to simulate.
+	const ScheduleObjective objective; // The wait time measure to minimize.
+	const unsigned numOfThreads; // The number of simulations run at once.
+	std::vector<int> startTimeGrid; // The start times tried for each car.
+	std::vector<int> parkingGrid; // The parking floors tried for each car.
+
+	/**
+	 * @brief Simulates the trace with one schedule in a quiet building.
+	 *
+	 * @tparam Policy The dispatch policy type.
+	 * @param schedule The schedule.
+	 * @return The mean and 95th percentile wait, infinite if the simulation failed.
+	 */
+	template <typename Policy>
+	Evaluation simulate(const CarSchedule& schedule) const {
+		Evaluation evaluation;
+		try {
+			Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "optimizer", trace, true);
+			building.setCarSchedule(schedule);
+			Policy policy;
+			building.simulate(policy);
+			evaluation.meanWait = building.getWaitTimeStat().getAverage();
+			evaluation.p95Wait = building.getWaitTimeStat().getPercentile(95);
+		}
+		catch (const std::exception&) {
+			// leave the wait infinite so the schedule is never chosen
+		}
+		return evaluation;
+	}
+
+	/**
+	 * @brief Lists the schedules that differ from a schedule in the start time or the parking floor of one car.
+	 *
+	 * Start times stay between those of the neighbouring cars, so cars still go into service in index order.
+	 *
+	 * @param schedule The current schedule.
+	 * @param car The car to change.
+	 * @return The candidate schedules.
+	 */
+	std::vector<CarSchedule> neighbours(const CarSchedule& schedule, int car) const {
+		std::vector<int> startTimes;
+		std::vector<int> parkingFloors;
+		for (int i = 0; i < numOfElevators; ++i) {
+			startTimes.push_back(schedule.getStartTime(i));
+			parkingFloors.push_back(schedule.getParkingFloor(i));
+		}
+
+		int earliest = car == 0 ? 0 : startTimes[car - 1];
+		int latest = car + 1 == numOfElevators ? std::numeric_limits<int>::max() : startTimes[car + 1];
+		std::vector<CarSchedule> candidates;
+		for (int startTime : startTimeGrid) {
+			if (startTime >= earliest && startTime <= latest && startTime != schedule.getStartTime(car)) {
+				std::vector<int> changed = startTimes;
+				changed[car] = startTime;
+				candidates.emplace_back(changed, parkingFloors);
+			}
+		}
+		for (int parkingFloor : parkingGrid) {
+			if (parkingFloor != schedule.getParkingFloor(car)) {
+				std::vector<int> changed = parkingFloors;
+				changed[car] = parkingFloor;
+				candidates.emplace_back(startTimes, changed);
+			}
+		}
+		return candidates;
+	}
+};
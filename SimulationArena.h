@@ -0,0 +1,91 @@
+/**
+ * @file SimulationArena.h
+ * @brief Declaration and implementation of the SimulationArena class.
+ *
+ * The SimulationArena class is the memory resource behind every container of one Building.
+ * Allocations are served from pooled free lists carved out of a monotonic buffer, so a simulation
+ * does not touch the global allocator in its inner loop and parallel Buildings do not contend.
+ * Everything is given back in a single release when the arena is destroyed.
+ */
+
+#pragma once
+#include <memory_resource>
+#include <cstddef>
+#include <algorithm>
+
+class SimulationArena : public std::pmr::memory_resource {
+public:
+	/**
+	 * @brief Constructs an empty arena.
+	 *
+	 * @param initialSize The size in bytes of the first buffer requested from the system.
+	 */
+	explicit SimulationArena(size_t initialSize = 64 * 1024)
+		: monotonic(initialSize, std::pmr::new_delete_resource()), pool(&monotonic) {
+	}
+
+	SimulationArena(const SimulationArena&) = delete;
+	SimulationArena& operator=(const SimulationArena&) = delete;
+
+	/**
+	 * @brief Gets the total number of bytes allocated through the arena, including bytes since freed.
+	 *
+	 * @return The total number of bytes.
+	 */
+	size_t getTotalBytes() const {
+		return totalBytes;
+	}
+
+	/**
+	 * @brief Gets the largest number of bytes that were in use at the same time.
+	 *
+	 * @return The peak number of bytes.
+	 */
+	size_t getPeakBytes() const {
+		return peakBytes;
+	}
+
+	/**
+	 * @brief Gets the number of bytes currently in use.
+	 *
+	 * @return The number of bytes in use.
+	 */
+	size_t getCurrentBytes() const {
+		return currentBytes;
+	}
+
+	/**
+	 * @brief Gets the number of allocations made through the arena.
+	 *
+	 * @return The number of allocations.
+	 */
+	size_t getAllocationCount() const {
+		return allocationCount;
+	}
+
+private:
+	std::pmr::monotonic_buffer_resource monotonic; // Grows in large buffers and releases them all at once.
+	std::pmr::unsynchronized_pool_resource pool; // Free lists per block size, carved out of the monotonic buffer.
+	size_t totalBytes = 0; // Bytes allocated over the lifetime of the arena.
+	size_t currentBytes = 0; // Bytes currently in use.
+	size_t peakBytes = 0; // Largest value of currentBytes.
+	size_t allocationCount = 0; // Number of allocations.
+
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		void* p = pool.allocate(bytes, alignment);
+		totalBytes += bytes;
+		currentBytes += bytes;
+		peakBytes = std::max(peakBytes, currentBytes);
+		++allocationCount;
+		return p;
+	}
+
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		pool.deallocate(p, bytes, alignment);
+		currentBytes -= bytes;
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
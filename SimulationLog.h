@@ -0,0 +1,33 @@
+/**
+ * @file SimulationLog.h
+ * @brief Opens the loggers of a simulation run.
+ *
+ * A normal run writes every logger to its own file under logs/ and registers it with spdlog by name.
+ * A quiet run, such as one of many runs made by an optimizer, gets loggers that are switched off and
+ * not registered, so nothing is formatted or written and runs in parallel cannot clash over names.
+ */
+
+#pragma once
+#include "spdlog/spdlog.h"
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Opens a logger for a simulation run.
+ *
+ * @param name The logger name, unique among the loggers of normal runs.
+ * @param fileLocation The file the logger writes to.
+ * @param quiet True to get a logger that drops every message.
+ * @return The logger.
+ */
+inline std::shared_ptr<spdlog::logger> openSimulationLogger(const std::string& name, const std::string& fileLocation, bool quiet) {
+	if (!quiet) {
+		return spdlog::basic_logger_mt(name, fileLocation);
+	}
+
+	auto logger = std::make_shared<spdlog::logger>(name, std::make_shared<spdlog::sinks::null_sink_st>());
+	logger->set_level(spdlog::level::off);
+	return logger;
+}
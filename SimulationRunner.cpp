@@ -13,11 +13,707 @@
 #pragma once
 
 #include "Building.h"
+#include "ScheduleOptimizer.h"
+#include "ParameterTuner.h"
+#include "OfflineSolver.h"
+#include "ElevatorEnv.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
 #include "spdlog/spdlog.h"
 #include <spdlog/sinks/basic_file_sink.h>
 
 using namespace std;
 
+/**
+ * @brief Stops the run if a result the demos rely on does not hold.
+ *
+ * @param condition The result that must hold.
+ * @param what What the result is, for the error message.
+ * @throw std::runtime_error if condition is false.
+ */
+void check(bool condition, const string& what) {
+	if (!condition) {
+		throw runtime_error("Check failed: " + what);
+	}
+}
+
+/**
+ * @brief Prints how much a candidate run lowered the mean wait and travel times of a baseline run.
+ *
+ * @param name The name of the building.
+ * @param baseline The building simulated with the reference policy.
+ * @param candidate The building simulated with the policy under test.
+ */
+void printImprovement(const string& name, const Building& baseline, const Building& candidate) {
+	double baseWait = baseline.getWaitTimeStat().getAverage();
+	double baseTravel = baseline.getTravelTimeStat().getAverage();
+	double wait = candidate.getWaitTimeStat().getAverage();
+	double travel = candidate.getTravelTimeStat().getAverage();
+
+	cout << name << ": mean wait " << baseWait << " -> " << wait << " (" << 100.0 * (baseWait - wait) / baseWait << "% lower), "
+		<< "mean travel " << baseTravel << " -> " << travel << " (" << 100.0 * (baseTravel - travel) / baseTravel << "% lower)" << endl;
+}
+
+/**
+ * @brief Prints the throughput and mean travel time of a candidate run next to those of a baseline run.
+ *
+ * @param name The name of the building.
+ * @param baseline The building simulated with the reference policy.
+ * @param candidate The building simulated with the policy under test.
+ */
+void printThroughput(const string& name, const Building& baseline, const Building& candidate) {
+	cout << name << ": throughput " << baseline.getThroughput() << " -> " << candidate.getThroughput() << " passengers/hour, "
+		<< "mean travel " << baseline.getTravelTimeStat().getAverage() << " -> " << candidate.getTravelTimeStat().getAverage() << endl;
+}
+
+/**
+ * @brief Searches for the car schedule with the lowest mean and 95th percentile wait under LOOK dispatch and prints it.
+ *
+ * @param name The name of the building.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+void printBestSchedule(const string& name, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, const vector<Passenger>& trace) {
+	CarSchedule staggered = CarSchedule::staggered(numOfElevators);
+	for (ScheduleObjective objective : { ScheduleObjective::MEAN_WAIT, ScheduleObjective::P95_WAIT }) {
+		ScheduleOptimizer optimizer(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, trace, objective);
+		ScheduleOptimizer::Evaluation before = optimizer.evaluate<LookPolicy>({ staggered }).front();
+		ScheduleOptimizer::Result best = optimizer.optimize<LookPolicy>(staggered);
+
+		cout << name << (objective == ScheduleObjective::MEAN_WAIT ? ", minimizing mean wait" : ", minimizing p95 wait")
+			<< " (" << best.evaluations << " simulations)" << endl;
+		cout << "  staggered: mean wait " << before.meanWait << ", p95 wait " << before.p95Wait << endl;
+		cout << "  best:      mean wait " << best.evaluation.meanWait << ", p95 wait " << best.evaluation.p95Wait << endl;
+		cout << "  schedule:  " << best.schedule.toString() << endl;
+	}
+}
+
+/**
+ * @brief Tunes the car schedule of a building under LOOK dispatch with the genetic algorithm, prints the best
+ * configuration and its convergence history, and writes the history to logs/<logFileName>_tuning.csv.
+ *
+ * @param name The name of the building.
+ * @param logFileName The file name prefix of the history.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+void printTuning(const string& name, const string& logFileName, int numOfFloors, int numOfElevators, int elevatorSpeed,
+	int elevatorStoppingTime, const vector<Passenger>& trace) {
+	// capacity and stopping time stay at the building's values; widen their ranges to tune them as well
+	TuningSpace space;
+	space.minStopTime = space.maxStopTime = elevatorStoppingTime;
+
+	ParameterTuner tuner(numOfFloors, numOfElevators, elevatorSpeed, trace, ScheduleObjective::MEAN_WAIT, space);
+	CarSchedule staggered = CarSchedule::staggered(numOfElevators);
+	TuningConfig initial;
+	for (int car = 0; car < numOfElevators; ++car) {
+		initial.startTimes.push_back(staggered.getStartTime(car));
+		initial.parkingFloors.push_back(staggered.getParkingFloor(car));
+	}
+	initial.stopTime = elevatorStoppingTime;
+	ParameterTuner::Result result = tuner.tune<LookPolicy>(initial);
+
+	cout << name << ": mean wait " << result.evaluation.meanWait << ", p95 wait " << result.evaluation.p95Wait << endl;
+	cout << "  configuration: " << result.config.toString() << endl;
+	for (const GenerationRecord& record : result.history) {
+		cout << "  generation " << record.generation << ": best " << record.bestScore << ", generation best " << record.generationBest
+			<< ", simulations " << record.simulations << ", cache hits " << record.cacheHits << ", stopped early " << record.aborted << endl;
+	}
+
+	ofstream history("logs/" + logFileName + "_tuning.csv");
+	ParameterTuner::writeHistory(result.history, history);
+}
+
+/**
+ * @brief Prints the offline lower bound and clairvoyant solution of a building, and how far online runs are from them.
+ *
+ * Times are mean journey times, from arrival to delivery.
+ *
+ * @param name The name of the building.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ * @param online The online runs of the building, with the name of their policy.
+ */
+void printOfflineGap(const string& name, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const vector<Passenger>& trace, const vector<pair<string, const Building*>>& online) {
+	OfflineSolver solver(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, trace, CarSchedule::staggered(numOfElevators));
+	OfflineSolver::Means bound = solver.lowerBound();
+	OfflineSolver::Solution clairvoyant = solver.solve();
+
+	cout << name << ": lower bound " << bound.journey() << " (wait " << bound.wait << ", travel " << bound.travel << "), "
+		<< "clairvoyant " << clairvoyant.means.journey() << " (wait " << clairvoyant.means.wait << ", travel " << clairvoyant.means.travel
+		<< ", horizon " << clairvoyant.horizon << "s)" << endl;
+	for (const auto& run : online) {
+		double journey = run.second->getWaitTimeStat().getAverage() + run.second->getTravelTimeStat().getAverage();
+		cout << "  " << run.first << ": " << journey << ", " << 100.0 * (journey - bound.journey()) / bound.journey() << "% above the bound, "
+			<< 100.0 * (journey - clairvoyant.means.journey()) / clairvoyant.means.journey() << "% above clairvoyant" << endl;
+	}
+}
+
+/**
+ * @brief Prints what the full-load bypass saves under one policy, by simulating the trace with it off and on.
+ *
+ * @tparam Policy The dispatch policy type, default constructible, see DispatchPolicy.h.
+ * @param policyName The name of the policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printFullLoadBypass(const string& policyName, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const vector<Passenger>& trace) {
+	Building withoutBypass(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "bypass_off", trace, true);
+	Policy stoppingPolicy;
+	stoppingPolicy.setFullLoadBypass(false);
+	withoutBypass.simulate(stoppingPolicy);
+
+	Building withBypass(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "bypass_on", trace, true);
+	Policy bypassPolicy;
+	withBypass.simulate(bypassPolicy);
+
+	cout << "  " << policyName << ": " << stoppingPolicy.getFullLoadCallCount() << " wasted stops, " << bypassPolicy.getFullLoadCallCount()
+		<< " calls passed by full cars, peak throughput " << withoutBypass.getPeakThroughput() << " -> " << withBypass.getPeakThroughput()
+		<< " passengers/hour, mean wait " << withoutBypass.getWaitTimeStat().getAverage() << " -> " << withBypass.getWaitTimeStat().getAverage() << endl;
+}
+
+/**
+ * @brief Simulates the trace under LOOK dispatch with a dwell model and prints where the time at stops went.
+ *
+ * @param label The name of the run.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param dwell The dwell model, or nullptr for the fixed stopping time.
+ * @param trace The passengers to simulate.
+ */
+void printDwell(const string& label, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const DwellModel* dwell, const vector<Passenger>& trace) {
+	Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "dwell", trace, true);
+	if (dwell != nullptr) {
+		building.setDwellModel(*dwell);
+	}
+	LookPolicy policy;
+	building.simulate(policy);
+
+	const StopTimeSink& stops = building.getStopTimes();
+	cout << "  " << label << ": mean wait " << building.getWaitTimeStat().getAverage() << ", mean travel " << building.getTravelTimeStat().getAverage()
+		<< ", " << stops.getStopCount() << " stops, " << static_cast<double>(stops.getTotalDuration()) / stops.getStopCount() << "s per stop ("
+		<< stops.getDoorTime() / stops.getStopCount() << "s doors, " << stops.getTransferTime() / stops.getStopCount() << "s transfer), "
+		<< stops.getReopenings() << " reopenings" << endl;
+}
+
+/**
+ * @brief Checks door reopening on a scenario where it must happen: one car at the lobby of a 10 floor building, a
+ * passenger calling it at time 0 and a second one arriving at the lobby while the doors close behind the first.
+ * Reopening lets the second passenger board at the cost of a longer stop; without it, the car leaves and comes back.
+ *
+ * @param elevatorSpeed The speed of the elevator (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param dwell The dwell model, whose reopen flag is overridden.
+ * @throw std::runtime_error if the doors do not reopen or the stop is not longer for it.
+ */
+void checkDoorReopening(int elevatorSpeed, int elevatorStoppingTime, DwellModel dwell) {
+	// the doors open for 2 seconds, then the first passenger boards and the doors close; the second one arrives meanwhile
+	const vector<Passenger> trace{ Passenger(1, 0, 1, 5), Passenger(2, 3, 1, 5) };
+	double meanDwell[2] = {};
+	size_t reopenings[2] = {};
+	for (bool reopen : { false, true }) {
+		Building building(10, 1, elevatorSpeed, elevatorStoppingTime, "reopen", trace, true);
+		dwell.reopen = reopen;
+		building.setDwellModel(dwell);
+		LookPolicy policy;
+		building.simulate(policy);
+
+		const StopTimeSink& stops = building.getStopTimes();
+		meanDwell[reopen] = static_cast<double>(stops.getTotalDuration()) / stops.getStopCount();
+		reopenings[reopen] = stops.getReopenings();
+		cout << "  late arrival, " << (reopen ? "reopening" : "no reopening") << ": " << stops.getStopCount() << " stops, "
+			<< meanDwell[reopen] << "s per stop, " << reopenings[reopen] << " reopenings, mean wait " << building.getWaitTimeStat().getAverage() << endl;
+	}
+	check(reopenings[false] == 0, "doors never reopen with reopening off");
+	check(reopenings[true] > 0, "doors reopen for a passenger arriving while they close");
+	check(meanDwell[true] > meanDwell[false], "reopening lengthens the stop");
+}
+
+/**
+ * @brief Prints the flight times of a kinematic car model and simulates the trace with it under LOOK dispatch,
+ * deciding at every floor and flying straight to the next event.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param kinematics The kinematic model of the cars.
+ * @param trace The passengers to simulate.
+ */
+void printKinematics(int numOfFloors, int numOfElevators, int elevatorStoppingTime, const CarKinematics& kinematics, const vector<Passenger>& trace) {
+	cout << "Flight time: 1 floor " << kinematics.flightTime(1) << "s, 10 floors " << kinematics.flightTime(10) << "s, 40 floors "
+		<< kinematics.flightTime(40) << "s" << endl;
+
+	for (bool eventDriven : { false, true }) {
+		Building building(numOfFloors, numOfElevators, 1, elevatorStoppingTime, "kinematics", trace, true);
+		building.setKinematics(kinematics);
+		building.setEventDrivenTravel(eventDriven);
+		LookPolicy policy;
+		auto start = chrono::steady_clock::now();
+		building.simulate(policy);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		cout << (eventDriven ? "  event-driven: " : "  per floor:    ") << "mean wait " << building.getWaitTimeStat().getAverage()
+			<< ", mean travel " << building.getTravelTimeStat().getAverage() << ", " << 1000 * seconds << " ms" << endl;
+	}
+}
+
+/**
+ * @brief Simulates the trace with a uniform fleet and with a mixed fleet under one policy and prints both.
+ *
+ * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+ * @param policyName The name of the policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param elevatorSpeed The speed of the uniform cars (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param fleet The specifications of the mixed fleet, one per car.
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printMixedFleet(const string& policyName, int numOfFloors, int elevatorSpeed, int elevatorStoppingTime, const vector<CarSpec>& fleet,
+	const vector<Passenger>& trace) {
+	cout << policyName << ": mean wait";
+	for (bool mixed : { false, true }) {
+		Building building(numOfFloors, static_cast<int>(fleet.size()), elevatorSpeed, elevatorStoppingTime, "mixed_fleet", trace, true);
+		if (mixed) {
+			building.setCarSpecs(fleet);
+		}
+		Policy policy;
+		building.simulate(policy);
+		cout << (mixed ? " -> " : " ") << building.getWaitTimeStat().getAverage() << " (travel " << building.getTravelTimeStat().getAverage() << ")";
+	}
+	cout << endl;
+}
+
+/**
+ * @brief Simulates the trace in a zoned building under one policy and prints the journey and per-leg times.
+ *
+ * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+ * @param policyName The name of the policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param elevatorSpeed The speed the topology is compared at (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param topology The elevator groups of the building.
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printZoned(const string& policyName, int numOfFloors, int elevatorSpeed, int elevatorStoppingTime, const ZoneTopology& topology,
+	const vector<Passenger>& trace) {
+	Building building(numOfFloors, topology.getNumOfCars(), elevatorSpeed, elevatorStoppingTime, "zoned", trace, true);
+	building.setTopology(topology);
+	Policy policy;
+	building.simulate(policy);
+
+	const JourneySink& journeys = building.getJourneys();
+	cout << policyName << ": mean journey " << journeys.getJourneyTimeStat().getAverage() << "s, " << journeys.getTransferCount() << " transfers";
+	for (size_t leg = 0; leg < journeys.getNumOfLegs(); ++leg) {
+		cout << "; leg " << leg + 1 << ": " << journeys.getLegWaitStat(leg).getCount() << " rides, wait " << journeys.getLegWaitStat(leg).getAverage()
+			<< "s, travel " << journeys.getLegTravelStat(leg).getAverage() << "s";
+	}
+	cout << endl;
+}
+
+/**
+ * @brief Simulates the trace with single and double-deck cars under one policy and prints the waits, travel times and stops.
+ *
+ * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printDoubleDeck(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, const vector<Passenger>& trace) {
+	CarSpec doubleDeck{ elevatorSpeed, elevatorStoppingTime, 8, {}, 2 };
+	for (int run = 0; run < 3; ++run) {
+		Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "double_deck", trace, true);
+		if (run > 0) {
+			building.setCarSpecs(vector<CarSpec>(numOfElevators, doubleDeck));
+		}
+		if (run > 1) {
+			building.setDoubleDeckLobby(1);
+		}
+		Policy policy;
+		building.simulate(policy);
+		cout << (run == 0 ? "single deck" : run == 1 ? "double deck" : "double deck, split lobby") << ": mean wait " << building.getWaitTimeStat().getAverage()
+			<< "s, travel " << building.getTravelTimeStat().getAverage() << "s, " << building.getStopTimes().getStopCount() << " stops" << endl;
+	}
+}
+
+/**
+ * @brief Simulates the trace under one policy with growing weights of energy against time and prints the waits and energy.
+ *
+ * @tparam Policy The dispatch policy type, see DispatchPolicy.h.
+ * @param policyName The name of the policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printEnergy(const string& policyName, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const vector<Passenger>& trace) {
+	for (double weight : { 0.0, 1000.0, 5000.0 }) {
+		Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "energy", trace, true);
+		Policy policy;
+		policy.setEnergyWeight(weight);
+		building.simulate(policy);
+		const CarEnergy energy = building.getEnergy();
+		cout << "  " << policyName << ", " << weight << " s/kWh: mean wait " << building.getWaitTimeStat().getAverage() << "s, "
+			<< energy.total() << " kWh (" << building.getEnergyPerPassenger() << " kWh per passenger; motoring " << energy.motoring
+			<< ", regenerated " << energy.regenerated << ", starts " << energy.startStop << ", standby " << energy.standby << ")" << endl;
+	}
+}
+
+/**
+ * @brief Simulates the trace under LOOK dispatch with one parking policy and prints the waits, energy and parking runs.
+ *
+ * @param name The name of the parking policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param parking The parking policy, or nullptr for the fixed parking floors of the car schedule.
+ * @param trace The passengers to simulate.
+ */
+void printParking(const string& name, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	unique_ptr<ParkingPolicy> parking, const vector<Passenger>& trace) {
+	Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "parking", trace, true);
+	building.setParkingPolicy(std::move(parking));
+	LookPolicy policy;
+	building.simulate(policy);
+	const ParkingTally& tally = building.getParkingTally();
+	cout << "  " << name << ": mean wait " << building.getWaitTimeStat().getAverage() << "s, " << building.getEnergyPerPassenger() << " kWh per passenger, "
+		<< tally.getDecisionCount() << " decisions, " << tally.getParkingRunCount() << " parking runs over " << tally.getFloorsRun() << " floors" << endl;
+}
+
+/**
+ * @brief Makes a synthetic day of traffic: half an hour each of up-peak, inter-floor, two-way and down-peak traffic.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param meanGap The mean time between arrivals, in seconds.
+ * @return The passengers, in order of arrival.
+ */
+vector<Passenger> makeDayTrace(int numOfFloors, double meanGap) {
+	const int phaseLength = 1800;
+	// share of each phase's passengers leaving the lobby, and heading for it
+	const double fromLobby[] = { 0.85, 0.05, 0.45, 0.05 };
+	const double toLobby[] = { 0.05, 0.05, 0.45, 0.85 };
+	mt19937 random(2026);
+	exponential_distribution<double> gap(1.0 / meanGap);
+	uniform_real_distribution<double> share(0.0, 1.0);
+	uniform_int_distribution<int> upperFloor(2, numOfFloors);
+
+	vector<Passenger> trace;
+	double time = 0;
+	for (int id = 1; (time += gap(random)) < 4 * phaseLength; ++id) {
+		const int phase = static_cast<int>(time) / phaseLength;
+		const double pick = share(random);
+		int start = upperFloor(random);
+		int end = upperFloor(random);
+		if (pick < fromLobby[phase]) {
+			start = 1;
+		}
+		else if (pick < fromLobby[phase] + toLobby[phase]) {
+			end = 1;
+		}
+		while (end == start) {
+			end = upperFloor(random);
+		}
+		trace.emplace_back(id, static_cast<int>(time), start, end);
+	}
+	return trace;
+}
+
+/**
+ * @brief Simulates a synthetic day under LOOK dispatch with traffic detection, prints the regimes, writes them
+ * to a CSV file and compares fixed parking floors with parking that follows the traffic mode.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ */
+void printTrafficModes(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime) {
+	vector<Passenger> day = makeDayTrace(numOfFloors, 20.0);
+	TrafficDetection detection;
+	detection.window = 600;
+	detection.holdTime = 120;
+	for (bool adaptive : { false, true }) {
+		Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "traffic_modes", day, true);
+		building.setTrafficDetection(detection);
+		if (adaptive) {
+			building.setParkingPolicy(make_unique<TrafficModeParking>(numOfFloors));
+		}
+		LookPolicy policy;
+		building.simulate(policy);
+
+		const TrafficClassifier& traffic = *building.getTrafficClassifier();
+		if (!adaptive) {
+			cout << "  " << day.size() << " passengers, regimes:";
+			for (const TrafficRegime& regime : traffic.getTimeline()) {
+				cout << " " << regime.startTime << "s " << toString(regime.mode) << ";";
+			}
+			cout << endl;
+			ofstream timeline("logs/traffic_regimes.csv");
+			traffic.writeTimeline(timeline, building.getElapsedTime());
+		}
+		cout << "  " << (adaptive ? "parking by traffic mode" : "fixed parking floors") << ": mean wait " << building.getWaitTimeStat().getAverage()
+			<< "s, travel " << building.getTravelTimeStat().getAverage() << "s" << endl;
+	}
+}
+
+/**
+ * @brief Simulates the trace with and without passenger patience and prints the waits and the share of passengers who left.
+ *
+ * @tparam Policy The dispatch policy type.
+ * @param policyName The name of the dispatch policy.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param model The patience of the passengers.
+ * @param trace The passengers to simulate.
+ */
+template <typename Policy>
+void printPatience(const string& policyName, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const PatienceModel& model, const vector<Passenger>& trace) {
+	for (bool patient : { false, true }) {
+		Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "patience", trace, true);
+		if (patient) {
+			building.setPatience(model);
+		}
+		Policy policy;
+		building.simulate(policy);
+		check(building.getDeliveredCount() + building.getAbandonedCount() + building.getBalkedCount() == building.getPassengerCount(),
+			policyName + ": every passenger is delivered, abandons or balks");
+		cout << "  " << policyName << (patient ? ", with patience" : ", everyone waits") << ": mean wait " << building.getWaitTimeStat().getAverage()
+			<< "s over " << building.getWaitTimeStat().getCount() << " riders";
+		if (patient) {
+			cout << ", " << building.getAbandonedCount() << " abandoned after " << building.getAbandonWaitStat().getAverage() << "s on average, "
+				<< building.getBalkedCount() << " balked, abandonment rate " << building.getAbandonmentRate();
+		}
+		cout << endl;
+	}
+}
+
+/**
+ * @brief Makes a trace of meetings ending: each sends a group of 5 to 15 people from its floor to one other floor, mostly the lobby.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfMeetings The number of meetings, ending at random times over an hour.
+ * @return One record per group, in order of arrival.
+ */
+vector<Passenger> makeMeetingTrace(int numOfFloors, int numOfMeetings) {
+	mt19937 random(2026);
+	uniform_int_distribution<int> endTime(0, 3599);
+	uniform_int_distribution<int> upperFloor(2, numOfFloors);
+	uniform_int_distribution<int> groupSize(5, 15);
+	uniform_real_distribution<double> share(0.0, 1.0);
+
+	vector<int> times(numOfMeetings);
+	for (int& time : times) {
+		time = endTime(random);
+	}
+	sort(times.begin(), times.end());
+
+	vector<Passenger> trace;
+	for (int meeting = 0; meeting < numOfMeetings; ++meeting) {
+		const int start = upperFloor(random);
+		int end = share(random) < 0.7 ? 1 : upperFloor(random);
+		while (end == start) {
+			end = upperFloor(random);
+		}
+		trace.emplace_back(meeting + 1, times[meeting], start, end, groupSize(random));
+	}
+	return trace;
+}
+
+/**
+ * @brief Replaces every group of a trace by its members, one record each.
+ *
+ * @param groups The trace with groups.
+ * @return The same people, one record per person, in order of arrival.
+ */
+vector<Passenger> splitIntoPeople(const vector<Passenger>& groups) {
+	vector<Passenger> people;
+	for (const Passenger& group : groups) {
+		for (int member = 0; member < group.getGroupSize(); ++member) {
+			people.emplace_back(static_cast<int>(people.size()) + 1, group.getStartTime(), group.getStartFloor(), group.getEndFloor());
+		}
+	}
+	return people;
+}
+
+/**
+ * @brief Simulates a trace under one dispatch policy and prints the waits and the records simulated.
+ *
+ * @tparam Policy The dispatch policy type.
+ * @param label What the run shows.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ * @param split True to let groups that do not fit board in part.
+ */
+template <typename Policy>
+void printGroups(const string& label, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const vector<Passenger>& trace, bool split) {
+	Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "groups", trace, true);
+	building.setGroupSplitting(split);
+	Policy policy;
+	building.simulate(policy);
+	cout << "  " << label << ": " << trace.size() << " records for " << building.getPassengerCount() << " people, mean wait "
+		<< building.getWaitTimeStat().getAverage() << "s, travel " << building.getTravelTimeStat().getAverage() << "s" << endl;
+}
+
+/**
+ * @brief Prints how fast a batch of environments steps when every car sweeps the shaft, as the full sweep does.
+ *
+ * @param name The name of the building.
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ */
+void printEnvBenchmark(const string& name, int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime,
+	const vector<Passenger>& trace) {
+	const int numOfEnvs = 16;
+	const int numOfSteps = 20000;
+	ElevatorEnv env(numOfEnvs, numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, trace, numOfSteps / 2);
+	vector<int> actions(static_cast<size_t>(numOfEnvs) * numOfElevators, ExternalControlPolicy::UP);
+
+	double totalReward = 0.0;
+	int episodes = 0;
+	auto start = chrono::steady_clock::now();
+	for (int step = 0; step < numOfSteps; ++step) {
+		const float* observations = env.step(actions.data());
+		for (int i = 0; i < numOfEnvs; ++i) {
+			totalReward += env.getRewards()[i];
+			episodes += env.getDones()[i];
+
+			// turn each car around at the ends of the shaft
+			for (int car = 0; car < numOfElevators; ++car) {
+				int& action = actions[static_cast<size_t>(i) * numOfElevators + car];
+				float floorNumber = observations[static_cast<size_t>(i) * env.getObservationSize() + car];
+				if (floorNumber >= numOfFloors) {
+					action = ExternalControlPolicy::DOWN;
+				}
+				else if (floorNumber <= 1) {
+					action = ExternalControlPolicy::UP;
+				}
+			}
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << name << ": " << numOfEnvs << " environments, " << 1e6 * seconds / numOfSteps << " us per batched step, "
+		<< numOfEnvs * numOfSteps / seconds << " environment steps per second, " << episodes << " episodes, mean reward "
+		<< totalReward / (static_cast<double>(numOfEnvs) * numOfSteps) << " per step" << endl;
+}
+
+/**
+ * @brief Checks that the full sweep still reproduces the reference means of Building 1 with every later feature off:
+ * no full-load bypass, the fixed stopping time and the fixed parking floors.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor), 10 for the reference means.
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers of Mod10_Assignment_Elevators.csv.
+ * @throw std::runtime_error if a mean is off by more than the printed precision.
+ */
+void checkBaseline(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, const vector<Passenger>& trace) {
+	Building building(numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, "baseline", trace, true);
+	FullSweepPolicy policy;
+	policy.setFullLoadBypass(false);
+	building.simulate(policy);
+
+	double wait = building.getWaitTimeStat().getAverage();
+	double travel = building.getTravelTimeStat().getAverage();
+	check(fabs(wait - 727.637) < 5e-4, "baseline mean wait is 727.637, got " + to_string(wait));
+	check(fabs(travel - 354.591) < 5e-4, "baseline mean travel is 354.591, got " + to_string(travel));
+	check(building.getDeliveredCount() == building.getPassengerCount(), "the baseline delivers every passenger");
+	cout << "Baseline: mean wait " << wait << ", mean travel " << travel << endl;
+}
+
+/**
+ * @brief Checks that stepping environments is deterministic: two batches on different thread counts see the same
+ * observations, rewards and dones for the same actions, and so does the first batch after a reset.
+ *
+ * @param numOfFloors The number of floors in the building.
+ * @param numOfElevators The number of elevators in the building.
+ * @param elevatorSpeed The speed of the elevators (in seconds per floor).
+ * @param elevatorStoppingTime The time taken for the elevator to stop at a floor (in seconds).
+ * @param trace The passengers to simulate.
+ * @throw std::runtime_error if two runs differ.
+ */
+void checkEnvDeterminism(int numOfFloors, int numOfElevators, int elevatorSpeed, int elevatorStoppingTime, const vector<Passenger>& trace) {
+	const int numOfEnvs = 4;
+	const int numOfSteps = 3000;
+	ElevatorEnv single(numOfEnvs, numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, trace, numOfSteps / 3, 1, 1);
+	ElevatorEnv pooled(numOfEnvs, numOfFloors, numOfElevators, elevatorSpeed, elevatorStoppingTime, trace, numOfSteps / 3, 1, 4);
+	const size_t observationCount = static_cast<size_t>(numOfEnvs) * single.getObservationSize();
+
+	// record one run of a fixed action sequence, comparing the pooled batch with it as it goes
+	mt19937 random(7);
+	uniform_int_distribution<int> action(ExternalControlPolicy::HOLD, ExternalControlPolicy::DOWN);
+	vector<vector<int>> actions(numOfSteps, vector<int>(static_cast<size_t>(numOfEnvs) * numOfElevators));
+	vector<vector<float>> observations(numOfSteps);
+	vector<vector<float>> rewards(numOfSteps);
+	int episodes = 0;
+	for (int step = 0; step < numOfSteps; ++step) {
+		for (int& next : actions[step]) {
+			next = action(random);
+		}
+		const float* first = single.step(actions[step].data());
+		const float* second = pooled.step(actions[step].data());
+		check(memcmp(first, second, observationCount * sizeof(float)) == 0, "pooled observations match at step " + to_string(step));
+		check(memcmp(single.getRewards(), pooled.getRewards(), numOfEnvs * sizeof(float)) == 0, "pooled rewards match at step " + to_string(step));
+		check(memcmp(single.getDones(), pooled.getDones(), numOfEnvs) == 0, "pooled dones match at step " + to_string(step));
+		observations[step].assign(first, first + observationCount);
+		rewards[step].assign(single.getRewards(), single.getRewards() + numOfEnvs);
+		for (int env = 0; env < numOfEnvs; ++env) {
+			episodes += single.getDones()[env];
+		}
+	}
+	check(episodes > 0, "the determinism run crosses an episode boundary");
+
+	// replay the same actions after a reset
+	single.reset();
+	for (int step = 0; step < numOfSteps; ++step) {
+		const float* replayed = single.step(actions[step].data());
+		check(equal(replayed, replayed + observationCount, observations[step].begin()), "replayed observations match at step " + to_string(step));
+		check(equal(single.getRewards(), single.getRewards() + numOfEnvs, rewards[step].begin()), "replayed rewards match at step " + to_string(step));
+	}
+	cout << "Environment stepping: " << numOfSteps << " steps over " << episodes << " episodes, identical across thread counts and after reset" << endl;
+}
+
 /**
  * @brief Main function to simulate elevator behavior in two buildings.
  *
@@ -44,5 +740,171 @@ int main() {
 	Building myBuilding2(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, "status_5sec_speed");
 	myBuilding2.simulate(); // Simulate elevator behavior in Building 2.
 
+	// Run the same buildings with LOOK dispatch, where cars turn around as soon as nothing is ahead of them
+	cout << "\n\n\nBuilding 1 with LOOK dispatch" << endl;
+	Building lookBuilding1(numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, "look_10sec_speed");
+	LookPolicy lookPolicy1;
+	lookBuilding1.simulate(lookPolicy1);
+
+	cout << "\n\n\nBuilding 2 with LOOK dispatch" << endl;
+	Building lookBuilding2(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, "look_5sec_speed");
+	LookPolicy lookPolicy2;
+	lookBuilding2.simulate(lookPolicy2);
+
+	// Run the same buildings with a group controller assigning every hall call to the car with the lowest ETA
+	cout << "\n\n\nBuilding 1 with group control" << endl;
+	Building groupBuilding1(numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, "group_10sec_speed");
+	GroupControlPolicy groupPolicy1;
+	groupBuilding1.simulate(groupPolicy1);
+
+	cout << "\n\n\nBuilding 2 with group control" << endl;
+	Building groupBuilding2(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, "group_5sec_speed");
+	GroupControlPolicy groupPolicy2;
+	groupBuilding2.simulate(groupPolicy2);
+
+	// Run the same buildings with destination dispatch, where passengers are assigned to cars as they arrive
+	cout << "\n\n\nBuilding 1 with destination dispatch" << endl;
+	Building destinationBuilding1(numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, "destination_10sec_speed");
+	DestinationDispatchPolicy destinationPolicy1;
+	destinationBuilding1.simulate(destinationPolicy1);
+
+	cout << "\n\n\nBuilding 2 with destination dispatch" << endl;
+	Building destinationBuilding2(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, "destination_5sec_speed");
+	DestinationDispatchPolicy destinationPolicy2;
+	destinationBuilding2.simulate(destinationPolicy2);
+
+	// Report how much LOOK and group control improve on the full sweep
+	cout << "\n\n\nLOOK improvement over full sweep" << endl;
+	printImprovement("Building 1", myBuilding1, lookBuilding1);
+	printImprovement("Building 2", myBuilding2, lookBuilding2);
+
+	cout << "\nGroup control improvement over full sweep" << endl;
+	printImprovement("Building 1", myBuilding1, groupBuilding1);
+	printImprovement("Building 2", myBuilding2, groupBuilding2);
+
+	cout << "\nDestination dispatch improvement over full sweep" << endl;
+	printImprovement("Building 1", myBuilding1, destinationBuilding1);
+	printImprovement("Building 2", myBuilding2, destinationBuilding2);
+
+	cout << "\nDestination dispatch against collective control (full sweep)" << endl;
+	printThroughput("Building 1", myBuilding1, destinationBuilding1);
+	printThroughput("Building 2", myBuilding2, destinationBuilding2);
+
+	// Measure the stops full cars no longer make for calls they cannot serve
+	cout << "\nFull-load bypass (off -> on)" << endl;
+	vector<Passenger> trace = Building::readTrace("Mod10_Assignment_Elevators.csv");
+	checkBaseline(numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, trace);
+	const int speeds[] = { elevatorSpeedTime1, elevatorSpeedTime2 };
+	for (int i = 0; i < 2; ++i) {
+		cout << "Building " << i + 1 << endl;
+		printFullLoadBypass<FullSweepPolicy>("full sweep", numOfFloors, numOfElevators, speeds[i], elevatorStoppingTime, trace);
+		printFullLoadBypass<LookPolicy>("LOOK", numOfFloors, numOfElevators, speeds[i], elevatorStoppingTime, trace);
+		printFullLoadBypass<GroupControlPolicy>("group control", numOfFloors, numOfElevators, speeds[i], elevatorStoppingTime, trace);
+		printFullLoadBypass<DestinationDispatchPolicy>("destination dispatch", numOfFloors, numOfElevators, speeds[i], elevatorStoppingTime, trace);
+	}
+
+	// Search the car start times and parking floors for each building, reusing one loaded trace for every run
+	cout << "\nBest car schedule under LOOK dispatch" << endl;
+	printBestSchedule("Building 1", numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, trace);
+	printBestSchedule("Building 2", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+
+	// Compare the online policies with what knowing the whole trace in advance could achieve
+	cout << "\nOffline reference (mean journey time)" << endl;
+	printOfflineGap("Building 1", numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, trace,
+		{ { "full sweep", &myBuilding1 }, { "LOOK", &lookBuilding1 }, { "group control", &groupBuilding1 }, { "destination dispatch", &destinationBuilding1 } });
+	printOfflineGap("Building 2", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace,
+		{ { "full sweep", &myBuilding2 }, { "LOOK", &lookBuilding2 }, { "group control", &groupBuilding2 }, { "destination dispatch", &destinationBuilding2 } });
+
+	// Tune the same knobs with a genetic algorithm, minimizing the mean wait
+	cout << "\nGenetic tuning under LOOK dispatch" << endl;
+	printTuning("Building 1", "status_10sec_speed", numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, trace);
+	printTuning("Building 2", "status_5sec_speed", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+
+	// Replace the fixed stopping time with door and boarding times
+	cout << "\nDoor dwell under LOOK dispatch, Building 2 (doors 2s open, 3s close, 1.2s per boarding, 1s per alighting)" << endl;
+	DwellModel dwell;
+	printDwell("fixed 2s stop", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, nullptr, trace);
+	dwell.reopen = false;
+	printDwell("dwell model", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, &dwell, trace);
+	dwell.reopen = true;
+	printDwell("dwell model with reopening", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, &dwell, trace);
+	// nobody in the trace arrives at a floor while a car closes its doors there, so show reopening on a scenario where it must happen
+	checkDoorReopening(elevatorSpeedTime2, elevatorStoppingTime, dwell);
+
+	// Replace the fixed time per floor with cars that accelerate, cruise and brake
+	cout << "\nKinematic cars (3.5 m floors, 2.5 m/s, 1 m/s^2, 1.5 m/s^3) under LOOK dispatch" << endl;
+	printKinematics(numOfFloors, numOfElevators, elevatorStoppingTime, CarKinematics(3.5, 2.5, 1.0, 1.5), trace);
+
+	// Mix car types: two locals, an express serving the lobby and the upper half, and a large slow service car
+	cout << "\nMixed fleet under Building 2 (4 locals at 5s/floor -> 2 locals, 3s/floor express to floors 50-100, 8s/floor service car for 16)" << endl;
+	CarSpec local{ elevatorSpeedTime2, elevatorStoppingTime, 8, {} };
+	CarSpec express{ 3, elevatorStoppingTime, 12, CarSpec::floorRange(50, numOfFloors) };
+	express.servedFloors.push_back(1);
+	CarSpec service{ 8, elevatorStoppingTime, 16, {} };
+	vector<CarSpec> fleet{ local, local, express, service };
+	printMixedFleet<LookPolicy>("LOOK", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, fleet, trace);
+	printMixedFleet<GroupControlPolicy>("group control", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, fleet, trace);
+	printMixedFleet<DestinationDispatchPolicy>("destination dispatch", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, fleet, trace);
+
+	// Split the building into a low and a high rise zone, linked by a shuttle between the lobby and a sky lobby
+	cout << "\nZoned building (2 low rise cars for floors 1-50, shuttle 1 <-> 51 at 2s/floor, 2 high rise cars for floors 51-100)" << endl;
+	CarSpec lowRise{ elevatorSpeedTime2, elevatorStoppingTime, 8, CarSpec::floorRange(1, 50) };
+	CarSpec shuttle{ 2, elevatorStoppingTime, 16, { 1, 51 } };
+	CarSpec highRise{ elevatorSpeedTime2, elevatorStoppingTime, 8, CarSpec::floorRange(51, numOfFloors) };
+	ZoneTopology zones({ { "low rise", 2, lowRise }, { "shuttle", 1, shuttle }, { "high rise", 2, highRise } }, numOfFloors);
+	ZoneTopology conventional({ { "conventional", 5, local } }, numOfFloors);
+	printZoned<GroupControlPolicy>("5 cars serving every floor, group control", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, conventional, trace);
+	printZoned<LookPolicy>("zoned, LOOK", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, zones, trace);
+	printZoned<GroupControlPolicy>("zoned, group control", numOfFloors, elevatorSpeedTime2, elevatorStoppingTime, zones, trace);
+
+	// Give every car a second deck, which serves the floor above the lower deck at the same stop
+	cout << "\nDouble-deck cars under Building 2 with LOOK dispatch" << endl;
+	printDoubleDeck<LookPolicy>(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+
+	// Trade waiting time for energy in the cost of assigning calls
+	cout << "\nEnergy-aware assignment under Building 2 (45% counterweight balance, 60% regeneration)" << endl;
+	printEnergy<GroupControlPolicy>("group control", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+	printEnergy<DestinationDispatchPolicy>("destination dispatch", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+
+	// Choose where cars wait once they run out of work
+	cout << "\nParking policies under Building 2 with LOOK dispatch" << endl;
+	printParking("fixed floors of the car schedule", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, nullptr, trace);
+	printParking("lobby", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, make_unique<LobbyParking>(), trace);
+	printParking("spread over zones", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, make_unique<SpreadParking>(), trace);
+	printParking("predictive, 5 min window", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime,
+		make_unique<PredictiveParking>(numOfFloors, 300), trace);
+
+	// Detect the traffic regime as passengers arrive, on a synthetic day with peaks
+	cout << "\nTraffic-mode detection on a synthetic day (10 min window, 2 min hold), Building 2, LOOK dispatch" << endl;
+	printTrafficModes(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime);
+
+	// Let passengers give up on a long wait or a long queue
+	PatienceModel patience;
+	patience.balkingQueueLength = 10;
+	cout << "\nPassenger patience under Building 2 (Weibull, mean 3 min, shape 2; balking at 10 waiting)" << endl;
+	printPatience<LookPolicy>("LOOK", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, patience, trace);
+	printPatience<GroupControlPolicy>("group control", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, patience, trace);
+	printPatience<DestinationDispatchPolicy>("destination dispatch", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, patience, trace);
+	printPatience<LookPolicy>("synthetic day, LOOK", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, patience,
+		makeDayTrace(numOfFloors, 20.0));
+
+	// Let meetings end and send their people to the same floor together
+	vector<Passenger> meetings = makeMeetingTrace(numOfFloors, 30);
+	vector<Passenger> attendees = splitIntoPeople(meetings);
+	cout << "\nGroup arrivals under Building 2: 30 meetings of 5 to 15 people ending over an hour" << endl;
+	printGroups<LookPolicy>("LOOK, one record per person", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, attendees, false);
+	printGroups<LookPolicy>("LOOK, groups board whole", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, meetings, false);
+	printGroups<LookPolicy>("LOOK, groups split across cars", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, meetings, true);
+	printGroups<DestinationDispatchPolicy>("destination dispatch, one record per person", numOfFloors, numOfElevators, elevatorSpeedTime2,
+		elevatorStoppingTime, attendees, false);
+	printGroups<DestinationDispatchPolicy>("destination dispatch, groups split across cars", numOfFloors, numOfElevators, elevatorSpeedTime2,
+		elevatorStoppingTime, meetings, true);
+
+	// Drive the cars from outside through the batched step API, check it is deterministic and time it
+	cout << "\nBatched environment stepping" << endl;
+	checkEnvDeterminism(numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+	printEnvBenchmark("Building 1", numOfFloors, numOfElevators, elevatorSpeedTime1, elevatorStoppingTime, trace);
+	printEnvBenchmark("Building 2", numOfFloors, numOfElevators, elevatorSpeedTime2, elevatorStoppingTime, trace);
+
 	return 0;
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 /*
  * Class: Statistic
- * Contain information on statistics. Can add numbers to ths list, calculate
- * standard deviation and mean.
+ * Contain information on statistics. Keeps a running sum and count so the
+ * mean is available at any time in constant memory, and a histogram with one
+ * bucket per unit for percentiles, so memory grows with the largest number
+ * rather than the count. The numbers themselves are only kept when requested,
+ * for printList.
  *
  * @date: 1/30/2024
  * @version: New
@@ -10,8 +13,14 @@
  */
 #include <string>
 #include <list>
+#include <memory_resource>
 #include <limits>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
 
 class Statistic
 {
@@ -20,12 +29,14 @@ public:
 	/**
 	* Constructor: Statistic
 	*
-	* Set the initial list of numbers.
+	* Create an empty statistic.
 	*
-	* @param numberList - list of numbers. Type: std::list<double>
+	* @param keepNumbers - whether to keep every number for printList. Type: bool
+	* @param resource - memory resource for the kept numbers. Type: std::pmr::memory_resource*
 	*
 	*/
-	explicit Statistic() {}
+	explicit Statistic(bool keepNumbers = false, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: keepNumbers(keepNumbers), histogram(resource), numberList(resource) {}
 
 	/**
 	  * Method: getAverage
@@ -35,35 +46,123 @@ public:
 	  * @return - mean of the list of numbers. Type: double
 	  */
 	double getAverage() const {
-		int sum = 0;
-		for (auto element : this->numberList) {
-			sum += element;
-		}
-
-		if (this->numberList.size() == 0) {
+		if (this->count == 0) {
 			return std::numeric_limits<double>::quiet_NaN();
 		}
 		else {
-			return static_cast<double>(sum) / this->numberList.size();
+			return static_cast<double>(sum) / this->count;
 		}
 	}
 
+	/**
+	  * Method: getSum
+	  *
+	  * Get the sum of all numbers added so far
+	  *
+	  * @return - sum of the numbers. Type: long long
+	  */
+	long long getSum() const {
+		return this->sum;
+	}
+
+	/**
+	  * Method: getCount
+	  *
+	  * Get how many numbers were added so far
+	  *
+	  * @return - number of numbers. Type: size_t
+	  */
+	size_t getCount() const {
+		return this->count;
+	}
+
 	/**
 	  * Method: addNumber
 	  *
 	  * Add a number to the list
 	  *
-	  * @param number - number to be added. Type: double
+	  * @param number - number to be added, not negative. Type: int
 	  * @return - void
+	  * @throw std::invalid_argument if the number is negative
 	  */
 	void addNumber(int number) {
-		this->numberList.push_back(number);
+		addNumber(number, 1);
+	}
+
+	/**
+	  * Method: addNumber
+	  *
+	  * Add the same number several times, e.g. the wait of every member of a group
+	  *
+	  * @param number - number to be added, not negative. Type: int
+	  * @param times - how many times to add it. Type: size_t
+	  * @return - void
+	  * @throw std::invalid_argument if the number is negative
+	  */
+	void addNumber(int number, size_t times) {
+		if (number < 0) {
+			throw std::invalid_argument("Statistic only holds non-negative numbers");
+		}
+		if (static_cast<size_t>(number) >= this->histogram.size()) {
+			this->histogram.resize(static_cast<size_t>(number) + 1, 0);
+		}
+		this->histogram[number] += static_cast<std::uint32_t>(times);
+		this->sum += static_cast<long long>(number) * static_cast<long long>(times);
+		this->count += times;
+		if (this->keepNumbers) {
+			this->numberList.insert(this->numberList.end(), times, number);
+		}
+	}
+
+	/**
+	  * Method: getPercentile
+	  *
+	  * Get the smallest number that at least the given percentage of the numbers do not exceed
+	  *
+	  * @param percent - percentage between 0 and 100, e.g. 95 for the 95th percentile. Type: double
+	  * @return - the percentile, NaN if no number was added. Type: double
+	  * @throw std::invalid_argument if percent is not between 0 and 100
+	  */
+	double getPercentile(double percent) const {
+		if (percent < 0.0 || percent > 100.0) {
+			throw std::invalid_argument("Percentile must be between 0 and 100");
+		}
+		if (this->count == 0) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+
+		// nearest rank: walk the buckets until the rank is covered
+		size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(percent / 100.0 * this->count)));
+		size_t seen = 0;
+		for (size_t number = 0; number < this->histogram.size(); ++number) {
+			seen += this->histogram[number];
+			if (seen >= rank) {
+				return static_cast<double>(number);
+			}
+		}
+		return static_cast<double>(this->histogram.size() - 1);
+	}
+
+	/**
+	  * Method: getCountAbove
+	  *
+	  * Get how many of the numbers are greater than a threshold
+	  *
+	  * @param threshold - the threshold. Type: int
+	  * @return - number of numbers above the threshold. Type: size_t
+	  */
+	size_t getCountAbove(int threshold) const {
+		size_t above = 0;
+		for (size_t number = static_cast<size_t>(std::max(threshold + 1, 0)); number < this->histogram.size(); ++number) {
+			above += this->histogram[number];
+		}
+		return above;
 	}
 
 	/**
 	  * Method: printList
 	  *
-	  * Print the list of numbers
+	  * Print the list of numbers. Empty unless the statistic keeps its numbers.
 	  *
 	  * @return - void
 	  */
@@ -77,5 +176,9 @@ public:
 	}
 
 private:
-	std::list<int> numberList;
+	bool keepNumbers;
+	long long sum = 0;
+	size_t count = 0;
+	std::pmr::vector<std::uint32_t> histogram;
+	std::pmr::list<int> numberList;
 };
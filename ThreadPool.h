@@ -0,0 +1,141 @@
+/**
+ * @file ThreadPool.h
+ * @brief Declaration and implementation of the ThreadPool class.
+ *
+ * The ThreadPool class runs batches of independent jobs on threads that live as long as the pool.
+ * parallelFor starts new threads on every call, which is fine for jobs that are whole simulations, but
+ * costs tens of microseconds per call; the pool is for callers that run a small batch many thousands of
+ * times, such as a batched environment stepping every simulation by one second.
+ */
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+class ThreadPool {
+public:
+	/**
+	 * @brief Constructs a ThreadPool and starts its threads.
+	 *
+	 * @param numOfThreads The number of threads running jobs, the caller of run included, 0 for one per hardware thread.
+	 */
+	explicit ThreadPool(unsigned numOfThreads = 0) {
+		if (numOfThreads == 0) {
+			numOfThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for (unsigned t = 1; t < numOfThreads; ++t) {
+			workers.emplace_back([this]() { work(); });
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @brief Stops and joins the threads of the pool.
+	 */
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	/**
+	 * @brief Gets the number of threads running jobs, the caller of run included.
+	 *
+	 * @return The number of threads.
+	 */
+	unsigned size() const {
+		return static_cast<unsigned>(workers.size()) + 1;
+	}
+
+	/**
+	 * @brief Calls a job for every index from 0 to count - 1 and returns once all of them have finished.
+	 *
+	 * The calling thread runs jobs too. The job must not throw, and run must not be called from a job.
+	 *
+	 * @param count The number of jobs.
+	 * @param job A callable taking the size_t index of a job.
+	 */
+	void run(size_t count, const std::function<void(size_t)>& job) {
+		if (workers.empty() || count <= 1) {
+			for (size_t i = 0; i < count; ++i) {
+				job(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			batchJob = &job;
+			batchSize = count;
+			next = 0;
+			busy = workers.size();
+			++generation;
+		}
+		wake.notify_all();
+
+		runJobs();
+
+		// wait for the workers still finishing their last job
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]() { return busy == 0; });
+		batchJob = nullptr;
+	}
+
+private:
+	std::vector<std::thread> workers; // The threads of the pool, besides the caller of run.
+	std::mutex mutex; // Guards the batch fields below.
+	std::condition_variable wake; // Signals the workers that a batch has started or the pool is stopping.
+	std::condition_variable done; // Signals the caller of run that a worker has finished the batch.
+	const std::function<void(size_t)>* batchJob = nullptr; // The job of the current batch.
+	size_t batchSize = 0; // The number of jobs in the current batch.
+	std::atomic<size_t> next{ 0 }; // The index of the next job to claim.
+	size_t busy = 0; // The number of workers that have not finished the current batch.
+	unsigned long long generation = 0; // Counts the batches, so a worker runs each batch once.
+	bool stopping = false; // Set when the pool is being destroyed.
+
+	/**
+	 * @brief Claims and runs jobs of the current batch until none are left.
+	 */
+	void runJobs() {
+		for (size_t i = next++; i < batchSize; i = next++) {
+			(*batchJob)(i);
+		}
+	}
+
+	/**
+	 * @brief The loop of a worker thread: wait for a batch, help run it, report back.
+	 */
+	void work() {
+		unsigned long long seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]() { return stopping || generation != seen; });
+				if (stopping) {
+					return;
+				}
+				seen = generation;
+			}
+
+			runJobs();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busy == 0) {
+				done.notify_one();
+			}
+		}
+	}
+};
@@ -0,0 +1,106 @@
+/**
+ * @file TimingWheel.h
+ * @brief Declaration and implementation of the TimingWheel class template.
+ *
+ * The TimingWheel class holds timers that fire at whole seconds of simulated time. Timers are hashed into
+ * a ring of slots by their expiry time, so scheduling one is an append and expiring the timers due now
+ * only walks the slot of the current second. A timer further out than one turn of the wheel stays in its
+ * slot and is skipped until the turn it is due. The cost of a tick therefore follows the number of timers
+ * due then, not the number of timers pending, and tens of thousands of waiting timers cost nothing until
+ * they fire.
+ *
+ * Timers are not cancelled; the owner ignores a timer whose subject has gone when it fires.
+ */
+
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+template <typename T>
+class TimingWheel {
+public:
+	/**
+	 * @brief Constructs an empty wheel.
+	 *
+	 * @param span The number of seconds one turn of the wheel should cover at least; rounded up to a power of two.
+	 * @param resource The memory resource for the slots and the timers.
+	 * @throw std::invalid_argument if the span is less than 1 second.
+	 */
+	explicit TimingWheel(int span = 1024, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: slots(resource) {
+		if (span < 1) {
+			throw std::invalid_argument("A timing wheel must span at least 1 second");
+		}
+		size_t size = 1;
+		while (size < static_cast<size_t>(span)) {
+			size <<= 1;
+		}
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	/**
+	 * @brief Schedules a timer.
+	 *
+	 * @param time The time the timer fires, in seconds, not before the next call to expire.
+	 * @param item The value handed back when the timer fires.
+	 */
+	void schedule(int time, const T& item) {
+		slots[static_cast<size_t>(time) & mask].push_back(Timer{ time, item });
+		++count;
+	}
+
+	/**
+	 * @brief Fires the timers due at the current time, in no particular order. Call it once for every second.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param fire A callable taking the value of each timer that fires.
+	 */
+	template <typename Visitor>
+	void expire(int currentTime, Visitor fire) {
+		auto& slot = slots[static_cast<size_t>(currentTime) & mask];
+		for (size_t i = 0; i < slot.size();) {
+			if (slot[i].time > currentTime) {
+				++i;
+				continue;
+			}
+
+			// take the timer out before firing, so the visitor may schedule new ones
+			T item = slot[i].item;
+			slot[i] = slot.back();
+			slot.pop_back();
+			--count;
+			fire(item);
+		}
+	}
+
+	/**
+	 * @brief Gets the number of timers pending.
+	 *
+	 * @return The number of timers.
+	 */
+	size_t size() const {
+		return count;
+	}
+
+	/**
+	 * @brief Checks if no timer is pending.
+	 *
+	 * @return True if the wheel is empty, false otherwise.
+	 */
+	bool empty() const {
+		return count == 0;
+	}
+
+private:
+	struct Timer {
+		int time; // The time the timer fires.
+		T item; // The value handed back.
+	};
+
+	std::pmr::vector<std::pmr::vector<Timer>> slots; // The timers of each slot, hashed by time.
+	size_t mask = 0; // The slot count minus one.
+	size_t count = 0; // The number of timers pending.
+};
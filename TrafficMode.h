@@ -0,0 +1,244 @@
+/**
+ * @file TrafficMode.h
+ * @brief Declaration and implementation of the online traffic-mode classifier.
+ *
+ * A TrafficClassifier watches the passengers arriving in the building and tells up-peak, down-peak,
+ * two-way and inter-floor traffic apart as the day goes on. Each arrival is counted as incoming (leaving
+ * the lobby), outgoing (heading for the lobby) or inter-floor, in a ring of time buckets covering a sliding
+ * window. Counting an arrival and expiring old buckets are O(1) amortized, and the memory is one bucket per
+ * bucketSeconds of the window, however busy the building is.
+ *
+ * The window is classified once a second from the shares of the three flows. A new mode only takes over
+ * once it has been seen for holdTime seconds without a break, so a short burst does not flip the regime.
+ * Every regime is kept in a timeline that can be written as CSV, for checking against the logs of a
+ * building management system. Dispatch and parking policies are told of every change (see DispatchPolicy.h
+ * and ParkingPolicy.h).
+ */
+
+#pragma once
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <cstddef>
+
+enum class TrafficMode : std::uint8_t {
+	INTER_FLOOR,
+	UP_PEAK,
+	DOWN_PEAK,
+	TWO_WAY,
+};
+
+/**
+ * @brief Gets the name of a traffic mode.
+ *
+ * @param mode The traffic mode.
+ * @return The name, as written in regime timelines.
+ */
+inline const char* toString(TrafficMode mode) {
+	switch (mode) {
+	case TrafficMode::UP_PEAK:
+		return "up-peak";
+	case TrafficMode::DOWN_PEAK:
+		return "down-peak";
+	case TrafficMode::TWO_WAY:
+		return "two-way";
+	default:
+		return "inter-floor";
+	}
+}
+
+/**
+ * @brief The settings of the traffic-mode classifier.
+ */
+struct TrafficDetection {
+	int lobbyFloor = 1; // The floor of the main lobby.
+	int window = 300; // The length of the sliding window, in seconds.
+	int bucketSeconds = 10; // The length of one bucket of the window, in seconds.
+	int minArrivals = 10; // The fewest arrivals in the window to call a peak; lighter traffic counts as inter-floor.
+	int holdTime = 60; // The time a new mode must be seen before it takes over, in seconds.
+	double peakShare = 0.6; // The share of incoming or outgoing arrivals that makes an up-peak or a down-peak.
+	double twoWayShare = 0.25; // The share of both incoming and outgoing arrivals that makes two-way traffic.
+
+	/**
+	 * @brief Checks the settings.
+	 *
+	 * @throw std::invalid_argument if the window or a bucket is less than 1 second, the window is not a whole
+	 * number of buckets, a count or the hold time is negative, the lobby is below floor 1, or a share is not between 0 and 1.
+	 */
+	void validate() const {
+		if (window < 1 || bucketSeconds < 1 || holdTime < 0 || window % bucketSeconds != 0) {
+			throw std::invalid_argument("The traffic window must be a whole number of buckets of at least 1 second");
+		}
+		if (lobbyFloor < 1 || minArrivals < 0 || peakShare < 0 || peakShare > 1 || twoWayShare < 0 || twoWayShare > 1) {
+			throw std::invalid_argument("Invalid traffic detection settings");
+		}
+	}
+};
+
+/**
+ * @brief A period of one traffic mode.
+ */
+struct TrafficRegime {
+	int startTime = 0; // The time the mode took over, in seconds.
+	TrafficMode mode = TrafficMode::INTER_FLOOR; // The traffic mode.
+};
+
+class TrafficClassifier {
+public:
+	/**
+	 * @brief Constructs a classifier with an empty window, in inter-floor mode.
+	 *
+	 * @param settings The settings of the classifier.
+	 * @throw std::invalid_argument if the settings are invalid, see TrafficDetection::validate.
+	 */
+	explicit TrafficClassifier(const TrafficDetection& settings = TrafficDetection())
+		: settings(validated(settings)), buckets(settings.window / settings.bucketSeconds, Counts{}) {
+		timeline.push_back(TrafficRegime{});
+	}
+
+	/**
+	 * @brief Counts a passenger arriving in the building.
+	 *
+	 * @param startFloor The floor the passenger arrives at.
+	 * @param endFloor The floor the passenger is going to.
+	 * @param currentTime The time of arrival, not earlier than the previous one.
+	 * @param count The number of people arriving together, e.g. a group.
+	 */
+	void record(int startFloor, int endFloor, int currentTime, int count = 1) {
+		advance(currentTime);
+		const int flow = startFloor == settings.lobbyFloor ? INCOMING : endFloor == settings.lobbyFloor ? OUTGOING : INTER_FLOOR;
+		buckets[head % buckets.size()][flow] += count;
+		totals[flow] += count;
+	}
+
+	/**
+	 * @brief Classifies the window at the current time and switches modes once a new one has held.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @return True if the mode changed, false otherwise.
+	 */
+	bool update(int currentTime) {
+		advance(currentTime);
+		const TrafficMode seen = classify();
+		if (seen != candidate) {
+			candidate = seen;
+			candidateSince = currentTime;
+		}
+		if (candidate == getMode() || currentTime - candidateSince < settings.holdTime) {
+			return false;
+		}
+		timeline.push_back(TrafficRegime{ currentTime, candidate });
+		return true;
+	}
+
+	/**
+	 * @brief Gets the current traffic mode.
+	 *
+	 * @return The mode.
+	 */
+	TrafficMode getMode() const {
+		return timeline.back().mode;
+	}
+
+	/**
+	 * @brief Gets the arrivals in the window by flow.
+	 *
+	 * @return The incoming, outgoing and inter-floor arrivals.
+	 */
+	const std::array<int, 3>& getWindowCounts() const {
+		return totals;
+	}
+
+	/**
+	 * @brief Gets every regime so far, in order.
+	 *
+	 * @return The regimes, the first starting at time 0.
+	 */
+	const std::vector<TrafficRegime>& getTimeline() const {
+		return timeline;
+	}
+
+	/**
+	 * @brief Writes the timeline as CSV with one "start time, end time, mode" line per regime after a header.
+	 *
+	 * @param out The stream to write to.
+	 * @param endTime The end of the last regime, usually the end of the simulation.
+	 */
+	void writeTimeline(std::ostream& out, int endTime) const {
+		out << "Start Time(s),End Time(s),Mode\n";
+		for (size_t i = 0; i < timeline.size(); ++i) {
+			const int end = i + 1 < timeline.size() ? timeline[i + 1].startTime : endTime;
+			out << timeline[i].startTime << ',' << end << ',' << toString(timeline[i].mode) << '\n';
+		}
+	}
+
+private:
+	using Counts = std::array<int, 3>;
+	static constexpr int INCOMING = 0; // Arrivals leaving the lobby.
+	static constexpr int OUTGOING = 1; // Arrivals heading for the lobby.
+	static constexpr int INTER_FLOOR = 2; // Arrivals between two other floors.
+
+	TrafficDetection settings; // The settings of the classifier.
+	std::vector<Counts> buckets; // The arrivals of each bucket of the window, as a ring.
+	Counts totals{}; // The arrivals in the window.
+	long long head = 0; // The number of the newest bucket, counted from time 0.
+	TrafficMode candidate = TrafficMode::INTER_FLOOR; // The mode the window was last classified as.
+	int candidateSince = 0; // The time the window was first classified as the candidate.
+	std::vector<TrafficRegime> timeline; // Every regime so far.
+
+	/**
+	 * @brief Checks the settings before the window is sized from them.
+	 *
+	 * @param settings The settings of the classifier.
+	 * @return The settings.
+	 * @throw std::invalid_argument if the settings are invalid.
+	 */
+	static const TrafficDetection& validated(const TrafficDetection& settings) {
+		settings.validate();
+		return settings;
+	}
+
+	/**
+	 * @brief Moves the window forward, emptying the buckets it leaves behind.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 */
+	void advance(int currentTime) {
+		const long long bucket = currentTime / settings.bucketSeconds;
+		for (long long steps = 0; head < bucket && steps < static_cast<long long>(buckets.size()); ++steps) {
+			Counts& expired = buckets[++head % buckets.size()];
+			for (int flow = 0; flow < 3; ++flow) {
+				totals[flow] -= expired[flow];
+			}
+			expired = Counts{};
+		}
+		head = std::max(head, bucket);
+	}
+
+	/**
+	 * @brief Classifies the window from the shares of the flows.
+	 *
+	 * @return The traffic mode of the window.
+	 */
+	TrafficMode classify() const {
+		const int total = totals[INCOMING] + totals[OUTGOING] + totals[INTER_FLOOR];
+		if (total == 0 || total < settings.minArrivals) {
+			return TrafficMode::INTER_FLOOR;
+		}
+		const double incoming = static_cast<double>(totals[INCOMING]) / total;
+		const double outgoing = static_cast<double>(totals[OUTGOING]) / total;
+		if (incoming >= settings.peakShare) {
+			return TrafficMode::UP_PEAK;
+		}
+		if (outgoing >= settings.peakShare) {
+			return TrafficMode::DOWN_PEAK;
+		}
+		if (incoming >= settings.twoWayShare && outgoing >= settings.twoWayShare) {
+			return TrafficMode::TWO_WAY;
+		}
+		return TrafficMode::INTER_FLOOR;
+	}
+};
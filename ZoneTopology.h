@@ -0,0 +1,401 @@
+/**
+ * @file ZoneTopology.h
+ * @brief Declaration and implementation of the zoned building topology and the JourneySink class.
+ *
+ * A ZoneTopology splits the cars of a building into groups, each serving its own zone of floors: low, mid
+ * and high rise locals, shuttles between the main lobby and a sky lobby, and so on. Floors served by more
+ * than one group are transfer floors. A trip no single group serves is split into legs: the passenger rides
+ * to a transfer floor, leaves the car, and joins the hall queue there for the next group, until they reach
+ * their destination. Routes take the fewest legs, and among those the transfer floor with the shortest way.
+ *
+ * The JourneySink sits between the cars and the building's delivery sinks. It passes on passengers who have
+ * reached their destination and sends the others on to their next leg, so the sinks downstream see one
+ * delivery per trip, with the waits of every leg added up and the end-to-end journey time as wait plus
+ * travel time. Wait and travel times are also kept per leg.
+ *
+ * A group of passengers keeps its size from leg to leg, and its trip ends once every member has arrived.
+ * A group split between cars on the way shares one journey record, so the legs of its parts are counted
+ * together and their per-leg statistics are approximate.
+ */
+
+#pragma once
+#include "CarSpec.h"
+#include "DeliverySink.h"
+#include "Statistic.h"
+#include "Passenger.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <optional>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief A group of identical cars serving one zone of the building.
+ */
+struct ElevatorGroup {
+	std::string name; // The name of the group, e.g. "low rise" or "shuttle".
+	int numOfCars = 1; // The number of cars in the group.
+	CarSpec car; // The specification of every car of the group; its served floors are the zone.
+};
+
+class ZoneTopology {
+public:
+	/**
+	 * @brief Constructs the topology of a building from its groups.
+	 *
+	 * Cars are numbered group by group, in the order the groups are given.
+	 *
+	 * @param groups The elevator groups.
+	 * @param numOfFloors The number of floors in the building.
+	 * @throw std::invalid_argument if there are no groups or more than 64, a group has no car or its car specification is invalid.
+	 * @throw std::out_of_range if a served floor is not in the building.
+	 */
+	ZoneTopology(std::vector<ElevatorGroup> groups, int numOfFloors)
+		: groups(std::move(groups)), floorGroups(numOfFloors + 1, 0) {
+		if (this->groups.empty() || this->groups.size() > 64) {
+			throw std::invalid_argument("A topology needs between 1 and 64 elevator groups");
+		}
+
+		for (size_t group = 0; group < this->groups.size(); ++group) {
+			const ElevatorGroup& elevatorGroup = this->groups[group];
+			if (elevatorGroup.numOfCars < 1) {
+				throw std::invalid_argument("Elevator group " + elevatorGroup.name + " needs at least one car");
+			}
+			elevatorGroup.car.validate(numOfFloors);
+			for (int floorNumber = 1; floorNumber <= numOfFloors; ++floorNumber) {
+				if (elevatorGroup.car.servedFloors.empty()) {
+					floorGroups[floorNumber] |= std::uint64_t{ 1 } << group;
+				}
+			}
+			for (int floorNumber : elevatorGroup.car.servedFloors) {
+				floorGroups[floorNumber] |= std::uint64_t{ 1 } << group;
+			}
+			for (int i = 0; i < elevatorGroup.numOfCars; ++i) {
+				groupOfCar.push_back(static_cast<int>(group));
+			}
+		}
+
+		for (int floorNumber = 1; floorNumber <= numOfFloors; ++floorNumber) {
+			if ((floorGroups[floorNumber] & (floorGroups[floorNumber] - 1)) != 0) {
+				transferFloors.push_back(floorNumber);
+			}
+		}
+	}
+
+	/**
+	 * @brief Gets the number of cars of every group together.
+	 *
+	 * @return The number of cars.
+	 */
+	int getNumOfCars() const {
+		return static_cast<int>(groupOfCar.size());
+	}
+
+	/**
+	 * @brief Gets the groups of the topology.
+	 *
+	 * @return The groups, in car order.
+	 */
+	const std::vector<ElevatorGroup>& getGroups() const {
+		return groups;
+	}
+
+	/**
+	 * @brief Gets the group a car belongs to.
+	 *
+	 * @param car The index of the car.
+	 * @return The index of the group.
+	 */
+	int getGroupOfCar(int car) const {
+		return groupOfCar[car];
+	}
+
+	/**
+	 * @brief Gets the specification of every car, for Building::setCarSpecs.
+	 *
+	 * @return One specification per car.
+	 */
+	std::vector<CarSpec> getCarSpecs() const {
+		std::vector<CarSpec> specs;
+		for (int group : groupOfCar) {
+			specs.push_back(groups[group].car);
+		}
+		return specs;
+	}
+
+	/**
+	 * @brief Gets the floors served by more than one group.
+	 *
+	 * @return The transfer floors, lowest first.
+	 */
+	const std::vector<int>& getTransferFloors() const {
+		return transferFloors;
+	}
+
+	/**
+	 * @brief Finds where the next leg of a trip ends.
+	 *
+	 * @param from The floor the passenger is on.
+	 * @param to The destination of the trip.
+	 * @return The destination if one group serves both floors, the transfer floor of the next leg of a route
+	 *         with the fewest legs otherwise, or 0 if no route exists.
+	 */
+	int nextLegFloor(int from, int to) const {
+		if ((floorGroups[from] & floorGroups[to]) != 0) {
+			return to;
+		}
+
+		// find the groups one leg from the destination, then two legs, and so on, until a group serving from is reached
+		std::uint64_t reached = floorGroups[to];
+		std::uint64_t previous = 0;
+		while ((reached & floorGroups[from]) == 0) {
+			std::uint64_t next = reached;
+			for (int floorNumber : transferFloors) {
+				if ((floorGroups[floorNumber] & reached) != 0) {
+					next |= floorGroups[floorNumber];
+				}
+			}
+			if (next == reached) {
+				return 0;
+			}
+			previous = reached;
+			reached = next;
+		}
+
+		// transfer from a group serving from to a group one leg closer to the destination, taking the shortest way
+		int best = 0;
+		int bestDistance = 0;
+		for (int floorNumber : transferFloors) {
+			if ((floorGroups[floorNumber] & floorGroups[from] & reached) != 0 && (floorGroups[floorNumber] & previous) != 0) {
+				int distance = std::abs(floorNumber - from) + std::abs(to - floorNumber);
+				if (best == 0 || distance < bestDistance) {
+					best = floorNumber;
+					bestDistance = distance;
+				}
+			}
+		}
+		return best;
+	}
+
+private:
+	std::vector<ElevatorGroup> groups; // The elevator groups.
+	std::vector<int> groupOfCar; // The group of each car.
+	std::vector<std::uint64_t> floorGroups; // Bitmask of the groups serving each floor, at index floor number.
+	std::vector<int> transferFloors; // The floors served by more than one group, lowest first.
+};
+
+/**
+ * @brief Splits trips into legs at transfer floors and passes on passengers once they reach their destination.
+ *
+ * Without a topology every trip is a single leg and every passenger is passed on as delivered.
+ */
+class JourneySink : public DeliverySink {
+public:
+	/**
+	 * @brief Sets the topology trips are routed through.
+	 *
+	 * @param zoneTopology The topology.
+	 */
+	void setTopology(const ZoneTopology& zoneTopology) {
+		topology = zoneTopology;
+	}
+
+	/**
+	 * @brief Checks if trips are routed through a topology.
+	 *
+	 * @return True if a topology is set, false otherwise.
+	 */
+	bool isZoned() const {
+		return topology.has_value();
+	}
+
+	/**
+	 * @brief Sets the sink receiving passengers who have reached their destination.
+	 *
+	 * @param sink The sink.
+	 */
+	void setDownstream(DeliverySink& sink) {
+		downstream = &sink;
+	}
+
+	/**
+	 * @brief Starts the trip of a passenger arriving in the building.
+	 *
+	 * @param passenger The arriving passenger.
+	 * @return The passenger as they wait for the first leg, with the first transfer floor as destination if the trip has several legs.
+	 * @throw std::runtime_error if no route leads to the destination.
+	 */
+	Passenger startJourney(const Passenger& passenger) {
+		if (!topology) {
+			return passenger;
+		}
+
+		int legEnd = nextLeg(passenger.getPassengerID(), passenger.getStartFloor(), passenger.getEndFloor());
+		if (legEnd == passenger.getEndFloor()) {
+			return passenger;
+		}
+
+		size_t id = static_cast<size_t>(passenger.getPassengerID());
+		if (id >= journeys.size()) {
+			journeys.resize(id + 1);
+		}
+		journeys[id] = Journey{ passenger.getStartFloor(), passenger.getEndFloor(), passenger.getStartTime(), 0, 0, passenger.getGroupSize() };
+		return Passenger(passenger.getPassengerID(), passenger.getStartTime(), passenger.getStartFloor(), legEnd, passenger.getGroupSize());
+	}
+
+	void deliver(const Passenger& passenger, int currentTime) override {
+		size_t id = static_cast<size_t>(passenger.getPassengerID());
+		Journey* journey = id < journeys.size() && journeys[id].endFloor != 0 ? &journeys[id] : nullptr;
+		addLeg(journey ? journey->legs : 0, passenger);
+
+		if (!journey) {
+			journeyTimeStat.addNumber(passenger.getWaitTime() + passenger.getTravelTime(), static_cast<size_t>(passenger.getGroupSize()));
+			downstream->deliver(passenger, currentTime);
+			return;
+		}
+
+		journey->waitTime += passenger.getWaitTime();
+		++journey->legs;
+		if (passenger.getEndFloor() != journey->endFloor) {
+			// walk over to the next group's hall and wait there from the next second
+			int legEnd = nextLeg(passenger.getPassengerID(), passenger.getEndFloor(), journey->endFloor);
+			transfers.emplace_back(passenger.getPassengerID(), currentTime + 1, passenger.getEndFloor(), legEnd, passenger.getGroupSize());
+			transferCount += static_cast<size_t>(passenger.getGroupSize());
+			return;
+		}
+
+		// pass on the whole trip: the waits of every leg, then the rest of the journey as travel time
+		Passenger trip(passenger.getPassengerID(), journey->startTime, journey->startFloor, journey->endFloor, passenger.getGroupSize());
+		trip.calculateWaitTime(journey->startTime + journey->waitTime);
+		trip.calculateTravelTime(currentTime);
+		journey->travelling -= passenger.getGroupSize();
+		journey->endFloor = journey->travelling > 0 ? journey->endFloor : 0;
+		journeyTimeStat.addNumber(currentTime - trip.getStartTime(), static_cast<size_t>(passenger.getGroupSize()));
+		downstream->deliver(trip, currentTime);
+	}
+
+	/**
+	 * @brief Hands the passengers due to start their next leg to a callable, in the order they transferred.
+	 *
+	 * @param currentTime The current simulation time in seconds.
+	 * @param join A callable taking a Passenger reference for each passenger joining a hall queue.
+	 */
+	template <typename Join>
+	void joinTransfers(int currentTime, Join join) {
+		while (!transfers.empty() && transfers.front().getStartTime() <= currentTime) {
+			Passenger passenger = transfers.front();
+			transfers.pop_front();
+			join(passenger);
+		}
+	}
+
+	/**
+	 * @brief Checks if passengers are on their way between two legs.
+	 *
+	 * @return True if a passenger has left a car at a transfer floor and not joined the next queue yet.
+	 */
+	bool hasPendingTransfers() const {
+		return !transfers.empty();
+	}
+
+	/**
+	 * @brief Gets the end-to-end journey times, from arrival in the building to arrival at the destination.
+	 *
+	 * @return The statistic of journey times.
+	 */
+	const Statistic& getJourneyTimeStat() const {
+		return journeyTimeStat;
+	}
+
+	/**
+	 * @brief Gets the number of legs any trip had.
+	 *
+	 * @return The largest number of legs.
+	 */
+	size_t getNumOfLegs() const {
+		return legWaitStats.size();
+	}
+
+	/**
+	 * @brief Gets the wait times of one leg of the trips.
+	 *
+	 * @param leg The leg, from 0 for the first.
+	 * @return The statistic of wait times of that leg.
+	 */
+	const Statistic& getLegWaitStat(size_t leg) const {
+		return legWaitStats[leg];
+	}
+
+	/**
+	 * @brief Gets the travel times of one leg of the trips.
+	 *
+	 * @param leg The leg, from 0 for the first.
+	 * @return The statistic of travel times of that leg.
+	 */
+	const Statistic& getLegTravelStat(size_t leg) const {
+		return legTravelStats[leg];
+	}
+
+	/**
+	 * @brief Gets the number of times a passenger changed cars at a transfer floor.
+	 *
+	 * @return The number of transfers.
+	 */
+	size_t getTransferCount() const {
+		return transferCount;
+	}
+
+private:
+	// A trip with more than one leg in progress.
+	struct Journey {
+		int startFloor; // The floor the passenger arrived on.
+		int endFloor; // The destination of the trip, or 0 once it has ended.
+		int startTime; // The time the passenger arrived in the building.
+		int waitTime; // The waits of the legs ridden so far.
+		int legs; // The number of legs ridden so far.
+		int travelling; // The members of the group not at the destination yet.
+	};
+
+	std::optional<ZoneTopology> topology; // The topology trips are routed through, if any.
+	DeliverySink* downstream = nullptr; // The sink receiving passengers at their destination.
+	std::vector<Journey> journeys; // The trips with more than one leg, by passenger ID.
+	std::deque<Passenger> transfers; // Passengers between two legs, in the order they left their cars.
+	std::deque<Statistic> legWaitStats; // The wait times of each leg.
+	std::deque<Statistic> legTravelStats; // The travel times of each leg.
+	Statistic journeyTimeStat; // The end-to-end journey times.
+	size_t transferCount = 0; // The number of transfers.
+
+	/**
+	 * @brief Finds where the next leg of a passenger's trip ends.
+	 *
+	 * @param passengerID The passenger's ID, for the error message.
+	 * @param from The floor the passenger is on.
+	 * @param to The destination of the trip.
+	 * @return The floor where the leg ends.
+	 * @throw std::runtime_error if no route leads to the destination.
+	 */
+	int nextLeg(int passengerID, int from, int to) const {
+		int legEnd = topology->nextLegFloor(from, to);
+		if (legEnd == 0) {
+			throw std::runtime_error("No route leads passenger " + std::to_string(passengerID) + " to floor " + std::to_string(to));
+		}
+		return legEnd;
+	}
+
+	/**
+	 * @brief Adds the wait and travel time of a finished leg to the statistics of that leg.
+	 *
+	 * @param leg The leg, from 0 for the first.
+	 * @param passenger The passenger at the end of the leg.
+	 */
+	void addLeg(int leg, const Passenger& passenger) {
+		while (legWaitStats.size() <= static_cast<size_t>(leg)) {
+			legWaitStats.emplace_back();
+			legTravelStats.emplace_back();
+		}
+		legWaitStats[leg].addNumber(passenger.getWaitTime(), static_cast<size_t>(passenger.getGroupSize()));
+		legTravelStats[leg].addNumber(passenger.getTravelTime(), static_cast<size_t>(passenger.getGroupSize()));
+	}
+};